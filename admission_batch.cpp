@@ -0,0 +1,240 @@
+#include "functions.cpp"
+#include <fstream>
+
+using namespace std;
+
+// Batch admission run for populations that do not fit in memory.
+//
+//   admission_batch [--budget-mb N] [--tmp DIR] [--scores [--seed N]] [--campus FILE]
+//                   [--roommates survey.csv] [--fees fees.conf [--cycle N] [--invoices FILE]]
+//                   [--scholarships schemes.conf [--awards FILE] [--eligibility FILE]]
+//                   [-o admitted.csv] [-v] applicants.csv
+//
+// applicants.csv holds one applicant per line:
+//   name,income,jee_rank,pref1;pref2;...,contact,percentage_12th,age,gender,category
+// (a header line starting with "name" is skipped). With --scores every line
+// also carries score,maths,physics; jee_rank is ignored and ranks come from
+// a merit list built over the whole file first (--seed picks the lottery
+// for exact ties). That list is built in memory, about 60 bytes per
+// applicant, and a file whose list would not fit in --budget-mb is
+// refused before allocation starts. Records are sorted on disk in runs of at most
+// --budget-mb (default 256) and merged straight into the allocator against
+// the --campus config, or the sample campus without one. Only admitted
+// students are kept in memory. --roommates rearranges rooms from survey
+// lines "roll,t1,...,t8[,requested_roll]" (rolls follow input order from
+// 1). --fees bills every admitted student for month --cycle (1-12, default
+// 1) and --invoices writes the invoices as CSV. --scholarships evaluates
+// every scheme against every admitted student; --awards writes the awards
+// as CSV and --eligibility the per-scheme bitmaps (see
+// ScholarshipRound::write_bitmaps). Without -v the per-applicant log is
+// discarded.
+
+int main(int argc, char** argv) {
+    size_t budget_mb = 256;
+    const char* tmp_env = getenv("TMPDIR");
+    string tmp_dir = tmp_env && *tmp_env ? tmp_env : "/tmp";
+    string export_path;
+    string campus_path;
+    string survey_path;
+    string fees_path;
+    string invoices_path;
+    int billing_cycle = 1;
+    string schemes_path;
+    string awards_path;
+    string bitmaps_path;
+    string input;
+    bool from_scores = false;
+    uint64_t lottery_seed = 0;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--budget-mb" && i + 1 < argc) budget_mb = std::max(1, atoi(argv[++i]));
+        else if (arg == "--tmp" && i + 1 < argc) tmp_dir = argv[++i];
+        else if (arg == "-o" && i + 1 < argc) export_path = argv[++i];
+        else if (arg == "--campus" && i + 1 < argc) campus_path = argv[++i];
+        else if (arg == "--roommates" && i + 1 < argc) survey_path = argv[++i];
+        else if (arg == "--fees" && i + 1 < argc) fees_path = argv[++i];
+        else if (arg == "--cycle" && i + 1 < argc) billing_cycle = atoi(argv[++i]);
+        else if (arg == "--invoices" && i + 1 < argc) invoices_path = argv[++i];
+        else if (arg == "--scholarships" && i + 1 < argc) schemes_path = argv[++i];
+        else if (arg == "--awards" && i + 1 < argc) awards_path = argv[++i];
+        else if (arg == "--eligibility" && i + 1 < argc) bitmaps_path = argv[++i];
+        else if (arg == "--scores") from_scores = true;
+        else if (arg == "--seed" && i + 1 < argc) lottery_seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "-v") verbose = true;
+        else if (input.empty() && arg[0] != '-') input = arg;
+        else {
+            input.clear();
+            break;
+        }
+    }
+    if (input.empty() || billing_cycle < 1 || billing_cycle > FeeSchedule::CYCLES ||
+        (!invoices_path.empty() && fees_path.empty()) ||
+        ((!awards_path.empty() || !bitmaps_path.empty()) && schemes_path.empty())) {
+        cerr << "usage: " << argv[0] << " [--budget-mb N] [--tmp DIR] [--scores [--seed N]] [--campus FILE]"
+             << " [--roommates survey.csv] [--fees fees.conf [--cycle N] [--invoices FILE]]"
+             << " [--scholarships schemes.conf [--awards FILE] [--eligibility FILE]]"
+             << " [-o admitted.csv] [-v] applicants.csv" << endl;
+        return 2;
+    }
+
+    CampusConfig campus = default_campus();
+    string error;
+    if (!campus_path.empty() && !campus.load(campus_path, error)) {
+        cerr << "admission_batch: " << error << endl;
+        return 1;
+    }
+
+    FeeSchedule fees;
+    if (!fees_path.empty() && !fees.load(fees_path, error)) {
+        cerr << "admission_batch: " << error << endl;
+        return 1;
+    }
+
+    ScholarshipCatalog schemes;
+    if (!schemes_path.empty() && !schemes.load(schemes_path, error)) {
+        cerr << "admission_batch: " << error << endl;
+        return 1;
+    }
+
+    vector<RoommateProfile> survey;
+    if (!survey_path.empty()) {
+        ifstream sin(survey_path);
+        if (!sin) {
+            cerr << "admission_batch: cannot open " << survey_path << endl;
+            return 1;
+        }
+        RoommateProfile profile;
+        string line;
+        size_t line_no = 0, bad = 0;
+        while (getline(sin, line)) {
+            ++line_no;
+            if (line.empty() || (line_no == 1 && line.compare(0, 4, "roll") == 0)) continue;
+            if (profile.parse_csv(line)) survey.push_back(profile);
+            else if (++bad <= 10) cerr << "admission_batch: skipping malformed survey line " << line_no << endl;
+        }
+    }
+
+    ifstream in(input);
+    if (!in) {
+        cerr << "admission_batch: cannot open " << input << endl;
+        return 1;
+    }
+
+    // Calls fn(record, index) for every well-formed line, index counting
+    // only accepted records.
+    size_t rejected = 0;
+    auto for_each_record = [&](auto fn) {
+        in.clear();
+        in.seekg(0);
+        rejected = 0;
+        ApplicantRecord rec;
+        string line;
+        size_t line_no = 0, index = 0;
+        while (getline(in, line)) {
+            ++line_no;
+            if (line.empty() || (line_no == 1 && line.compare(0, 4, "name") == 0)) continue;
+            if (!rec.parse_csv(line) || (from_scores && !rec.has_score)) {
+                if (++rejected <= 10) cerr << "admission_batch: skipping malformed line " << line_no << endl;
+                continue;
+            }
+            fn(rec, index++);
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<int> rank_of;
+    if (from_scores) {
+        // The merit list and rank_of are the only parts not bounded by
+        // the sorter, so they are checked against the budget as they grow.
+        const size_t per_record = MeritListBuilder::BYTES_PER_RECORD + sizeof(int);
+        const size_t max_records = (budget_mb << 20) / per_record;
+        vector<ScoreRecord> scores;
+        size_t candidates = 0;
+        for_each_record([&](const ApplicantRecord& rec, size_t index) {
+            if (++candidates > max_records) return;
+            scores.push_back(ScoreRecord{(uint32_t)index, rec.score, rec.maths, rec.physics,
+                                         rec.percentage_12th, rec.age, parse_category(rec.category)});
+        });
+        if (candidates > max_records) {
+            cerr << "admission_batch: --scores ranks in memory (" << per_record << " bytes per applicant); "
+                 << candidates << " applicants need "
+                 << ((candidates * per_record) >> 20) + 1 << " MB, above --budget-mb " << budget_mb << endl;
+            return 1;
+        }
+        vector<MeritRank> ranks = MeritListBuilder(lottery_seed).build(scores);
+        rank_of.resize(scores.size());
+        for (const MeritRank& r : ranks) rank_of[r.id] = r.common_rank;
+        cerr << "admission_batch: ranked " << ranks.size() << " candidates in " << fixed << setprecision(2)
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << "s" << endl;
+    }
+
+    ExternalMeritSorter merit(budget_mb << 20, tmp_dir);
+    for_each_record([&](ApplicantRecord& rec, size_t index) {
+        if (from_scores) rec.jee_rank = rank_of[index];
+        merit.add(rec);
+    });
+    rank_of = vector<int>();
+    double load_secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << "admission_batch: read " << merit.total() << " applicants (" << rejected
+         << " malformed) in " << fixed << setprecision(2) << load_secs << "s, "
+         << merit.spilled_runs() << " sorted runs" << endl;
+
+    ofstream discard;
+    streambuf* console = cout.rdbuf();
+    if (!verbose) {
+        discard.open("/dev/null");
+        cout.rdbuf(discard.rdbuf());
+    }
+
+    AdmissionOffice office;
+    office.export_metrics_from_env();
+    office.set_run_export(export_path);
+    office.load_campus(campus);
+
+    ApplicantStore admitted;
+    auto run_start = chrono::steady_clock::now();
+    office.process_out_of_core(merit, admitted);
+    double run_secs = chrono::duration<double>(chrono::steady_clock::now() - run_start).count();
+
+    cout.rdbuf(console);
+    if (run_arena().bytes_reserved() > (budget_mb << 20)) {
+        cerr << "admission_batch: warning: " << (run_arena().bytes_reserved() >> 20)
+             << " MB of applicant data kept, above --budget-mb" << endl;
+    }
+    cerr << "admission_batch: allocated in " << run_secs << "s ("
+         << (size_t)(merit.total() / std::max(run_secs, 1e-9)) << " applicants/s)" << endl;
+
+    if (!survey_path.empty()) {
+        printSection("ROOMMATE MATCHING");
+        for (const auto& r : office.match_roommates(admitted, survey, lottery_seed)) r.second.print(r.first);
+    }
+
+    if (!fees_path.empty()) {
+        printSection("BILLING");
+        BillingCycle bill = office.billing_cycle(admitted, fees, billing_cycle);
+        bill.compute(fees).print();
+        if (!invoices_path.empty() && !bill.write_invoices(invoices_path, admitted, fees)) {
+            cerr << "admission_batch: cannot write " << invoices_path << endl;
+        }
+    }
+
+    if (!schemes_path.empty()) {
+        printSection("SCHOLARSHIPS");
+        ScholarshipRound round;
+        round.add_admitted(admitted);
+        round.evaluate(schemes).print();
+        round.print_results(schemes);
+        if (!awards_path.empty() && !round.write_awards(awards_path, admitted, schemes)) {
+            cerr << "admission_batch: cannot write " << awards_path << endl;
+        }
+        if (!bitmaps_path.empty() && !round.write_bitmaps(bitmaps_path, admitted)) {
+            cerr << "admission_batch: cannot write " << bitmaps_path << endl;
+        }
+    }
+
+    office.show_detailed_report();
+    office.get_stats().print_summary();
+    MemoryAccounting::print_report();
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "functions.cpp"
+
+using namespace std;
+
+// Command-line client for admission_daemon.
+//
+//   admission_client [-s socket] submit NAME INCOME RANK PREFS CONTACT 12TH% AGE GENDER CATEGORY
+//   admission_client [-s socket] status ROLL
+//   admission_client [-s socket] run
+//   admission_client [-s socket] summary
+//   admission_client [-s socket] bench ROLL COUNT
+//
+// PREFS is a comma-separated list of branches or "University / Branch"
+// programs, best first. `bench` sends COUNT status
+// lookups over one connection and prints the latency distribution.
+
+static int connect_daemon(const string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool call(int fd, WireOp op, const WireWriter& req, WireStatus& status, string& reply) {
+    uint8_t code;
+    if (!wire_send(fd, (uint8_t)op, req.data()) || !wire_recv(fd, code, reply)) return false;
+    status = (WireStatus)code;
+    return true;
+}
+
+static const char* status_name(WireStatus s) {
+    switch (s) {
+    case WireStatus::Ok: return "ok";
+    case WireStatus::NotFound: return "not found";
+    case WireStatus::BadRequest: return "bad request";
+    case WireStatus::Unavailable: return "unavailable";
+    }
+    return "unknown";
+}
+
+static vector<string> split_preferences(const string& line) {
+    vector<string> out;
+    string token;
+    istringstream iss(line);
+    while (getline(iss, token, ',')) {
+        if (!token.empty()) out.push_back(token);
+    }
+    return out;
+}
+
+static int usage(const char* prog) {
+    cerr << "usage: " << prog << " [-s socket] submit NAME INCOME RANK PREFS CONTACT 12TH% AGE GENDER CATEGORY\n"
+         << "       " << prog << " [-s socket] status ROLL\n"
+         << "       " << prog << " [-s socket] run\n"
+         << "       " << prog << " [-s socket] summary\n"
+         << "       " << prog << " [-s socket] bench ROLL COUNT" << endl;
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* env = getenv("ADMISSION_SOCKET");
+    string path = env && *env ? env : "/tmp/admission.sock";
+    int arg = 1;
+    if (arg + 1 < argc && string(argv[arg]) == "-s") {
+        path = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg >= argc) return usage(argv[0]);
+    string cmd = argv[arg++];
+    vector<string> args(argv + arg, argv + argc);
+
+    int fd = connect_daemon(path);
+    if (fd < 0) {
+        cerr << "admission_client: cannot connect to " << path << endl;
+        return 1;
+    }
+
+    WireWriter req;
+    WireStatus status = WireStatus::Ok;
+    string reply;
+    int rc = 0;
+
+    if (cmd == "submit" && args.size() == 9) {
+        ApplicantRecord rec;
+        rec.name = args[0];
+        rec.income = atoi(args[1].c_str());
+        rec.jee_rank = atoi(args[2].c_str());
+        rec.preferences = split_preferences(args[3]);
+        rec.contact = args[4];
+        rec.percentage_12th = atoi(args[5].c_str());
+        rec.age = atoi(args[6].c_str());
+        rec.gender = args[7];
+        rec.category = args[8];
+        rec.encode(req);
+        if (!call(fd, WireOp::Submit, req, status, reply)) rc = 1;
+        else if (status == WireStatus::Ok) {
+            WireReader in(reply);
+            cout << "Submitted " << rec.name << " as roll " << in.i32() << endl;
+        }
+    } else if (cmd == "status" && args.size() == 1) {
+        req.i32(atoi(args[0].c_str()));
+        if (!call(fd, WireOp::Status, req, status, reply)) rc = 1;
+        else if (status == WireStatus::Ok) {
+            WireReader in(reply);
+            long long epoch = in.i64();
+            int roll = in.i32();
+            string name = in.str();
+            int rank = in.i32();
+            bool eligible = in.u8(), admitted = in.u8();
+            string university = in.str(), branch = in.str();
+            bool hostel = in.u8(), mess = in.u8();
+            string plan = in.str();
+            string room = in.str();
+            string outlet = in.str();
+            cout << "Roll " << roll << " | " << name << " | Rank: " << rank << " | epoch " << epoch << endl;
+            if (!eligible) cout << "  Not eligible" << endl;
+            else if (!admitted) cout << "  Not admitted" << endl;
+            else {
+                cout << "  Admitted: " << university << " / " << branch << endl;
+                cout << "  Hostel: " << (hostel ? (room.empty() ? string("Yes") : room) : string("No"))
+                     << " | Mess: " << (mess ? (outlet.empty() ? plan : plan + " at " + outlet) : string("No")) << endl;
+            }
+        }
+    } else if (cmd == "run" && args.empty()) {
+        if (!call(fd, WireOp::RunRound, req, status, reply)) rc = 1;
+        else if (status == WireStatus::Ok) {
+            WireReader in(reply);
+            long long admitted = in.i64();
+            long long epoch = in.i64();
+            cout << "Round complete: " << admitted << " admitted in total (epoch " << epoch << ")" << endl;
+        }
+    } else if (cmd == "summary" && args.empty()) {
+        if (!call(fd, WireOp::Summary, req, status, reply)) rc = 1;
+        else if (status == WireStatus::Ok) {
+            WireReader in(reply);
+            long long epoch = in.i64();
+            long long applicants = in.i64(), eligible = in.i64(), admitted = in.i64();
+            long long hostel = in.i64(), mess = in.i64();
+            cout << "Epoch " << epoch << " | Applicants: " << applicants
+                 << " | Eligible (last round): " << eligible << " | Admitted: " << admitted
+                 << " | Hostel: " << hostel << " | Mess: " << mess << endl;
+        }
+    } else if (cmd == "bench" && args.size() == 2) {
+        req.i32(atoi(args[0].c_str()));
+        int count = std::max(1, atoi(args[1].c_str()));
+        vector<long long> ns;
+        ns.reserve(count);
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < count && rc == 0; ++i) {
+            auto t0 = chrono::steady_clock::now();
+            if (!call(fd, WireOp::Status, req, status, reply)) rc = 1;
+            ns.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count());
+        }
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        sort(ns.begin(), ns.end());
+        auto pct = [&ns](double p) { return ns[std::min(ns.size() - 1, (size_t)(p * ns.size()))] / 1000.0; };
+        cout << fixed << setprecision(1)
+             << ns.size() << " lookups, " << (ns.size() / secs) << " req/s | p50 " << pct(0.50)
+             << " us | p99 " << pct(0.99) << " us | p99.9 " << pct(0.999)
+             << " us | max " << ns.back() / 1000.0 << " us" << endl;
+    } else {
+        close(fd);
+        return usage(argv[0]);
+    }
+
+    close(fd);
+    if (rc != 0) {
+        cerr << "admission_client: connection lost" << endl;
+        return 1;
+    }
+    if (status != WireStatus::Ok) {
+        cerr << "admission_client: " << status_name(status) << endl;
+        return 1;
+    }
+    return 0;
+}
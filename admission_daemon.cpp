@@ -0,0 +1,85 @@
+#include "functions.cpp"
+#include <csignal>
+#include <fstream>
+
+using namespace std;
+
+// Long-running admission service. Owns one AdmissionOffice with the default
+// campus and serves the wire protocol on a Unix socket until SIGINT/SIGTERM.
+//
+//   admission_daemon [-s socket] [-m shm-name] [-c campus.conf] [-o admitted.csv] [-v]
+//
+// The socket defaults to $ADMISSION_SOCKET or /tmp/admission.sock. The seat
+// table is mirrored into the shared-memory segment $ADMISSION_SEAT_SHM or
+// /admission_seats for help-desk consoles. With -o every round writes its
+// admitted students to a CSV when it finishes. Without -v the
+// per-applicant allocation log is discarded. Without -c the sample campus
+// is used.
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int) { stop_requested = 1; }
+
+int main(int argc, char** argv) {
+    const char* env = getenv("ADMISSION_SOCKET");
+    string path = env && *env ? env : "/tmp/admission.sock";
+    const char* shm_env = getenv("ADMISSION_SEAT_SHM");
+    string shm_name = shm_env && *shm_env ? shm_env : "/admission_seats";
+    string export_path;
+    string campus_path;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) path = argv[++i];
+        else if (arg == "-m" && i + 1 < argc) shm_name = argv[++i];
+        else if (arg == "-o" && i + 1 < argc) export_path = argv[++i];
+        else if (arg == "-c" && i + 1 < argc) campus_path = argv[++i];
+        else if (arg == "-v") verbose = true;
+        else {
+            cerr << "usage: " << argv[0] << " [-s socket] [-m shm-name] [-c campus.conf] [-o admitted.csv] [-v]" << endl;
+            return 2;
+        }
+    }
+
+    CampusConfig campus = default_campus();
+    string error;
+    if (!campus_path.empty() && !campus.load(campus_path, error)) {
+        cerr << "admission_daemon: " << error << endl;
+        return 1;
+    }
+
+    ofstream discard;
+    streambuf* console = cout.rdbuf();
+    if (!verbose) {
+        discard.open("/dev/null");
+        cout.rdbuf(discard.rdbuf());
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    AdmissionOffice office;
+    office.export_metrics_from_env();
+    office.set_run_export(export_path);
+    office.load_campus(campus);
+    if (!office.share_seat_table(shm_name)) {       // sized for the campus just loaded
+        cerr << "admission_daemon: cannot create seat table " << shm_name << endl;
+    }
+
+    AdmissionDaemon daemon(office, path);
+    if (!daemon.is_listening()) {
+        cout.rdbuf(console);
+        cerr << "admission_daemon: cannot listen on " << path << endl;
+        return 1;
+    }
+    cerr << "admission_daemon: listening on " << path << endl;
+
+    while (!stop_requested) {
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+
+    daemon.stop();
+    cout.rdbuf(console);
+    cerr << "admission_daemon: stopped" << endl;
+    return 0;
+}
@@ -1,6 +1,13 @@
 #include "university_admission.h"
 #include <iomanip>
 #include <algorithm>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
 
 void printHeader(const string& title) {
     cout << "\n" << string(60, '=') << endl;
@@ -14,522 +21,4540 @@ void printSection(const string& title) {
     cout << string(40, '-') << endl;
 }
 
-int Student::next_roll = 1;
+namespace {
 
-Student::Student(string name_,
-                 int income_,
-                 int jee_rank_,
-                 vector<string> preferred_branches_,
-                 string contact_number_,
-                 int percentage_12th_,
-                 int age_,
-                 string gender_,
-                 string category_) :
-    roll_number(next_roll++),
-    name(std::move(name_)),
-    income(std::max(0, income_)),
-    preferred_branches(std::move(preferred_branches_)),
-    contact_number(std::move(contact_number_)),
-    percentage_12th(std::max(0, std::min(100, percentage_12th_))),
-    age(std::max(0, age_)),
-    gender(std::move(gender_)),
-    category(std::move(category_)),
-    admitted(false),
-    assigned_branch(""),
-    hostel_allocated(false),
-    mess_allocated(false),
-    mess_plan(""),
-    jee_rank(std::max(1, jee_rank_))
-{
-    if (find(CATEGORIES.begin(), CATEGORIES.end(), category) == CATEGORIES.end()) {
-        category = "General";
-    }
+// Counters are sharded like MetricCounter, so an allocation touches only
+// its own thread's cache line. Live bytes are the sum over shards; the
+// peak is taken from that sum on every large block and on every
+// MEM_PEAK_SAMPLE-th allocation of a thread, and again in usage().
+struct alignas(64) MemShard {
+    atomic<long long> live[MEM_TAG_COUNT];
+    atomic<long long> allocations[MEM_TAG_COUNT];
+    atomic<long long> frees[MEM_TAG_COUNT];
+};
 
-    transform(gender.begin(), gender.end(), gender.begin(), ::tolower);
-    if (gender != "male" && gender != "female" && gender != "m" && gender != "f") {
-        gender = "male";
-    } else {
-        if (gender == "m") gender = "male";
-        if (gender == "f") gender = "female";
-    }
-}
+const unsigned MEM_PEAK_SAMPLE = 64;
+const size_t MEM_LARGE_BLOCK = 4096;
 
-bool Student::is_eligible(int min_percentage_12th, int min_age) const {
-    return (percentage_12th >= min_percentage_12th) && (age >= min_age);
+MemShard mem_shards[METRIC_SHARDS];
+atomic<long long> mem_peaks[MEM_TAG_COUNT];
+thread_local MemTag current_mem_tag = MEM_OTHER;
+thread_local unsigned mem_peak_countdown = MEM_PEAK_SAMPLE;
+thread_local int mem_shard = -1;    // metric_shard(), cached without an init guard
+
+MemShard& this_mem_shard() {
+    if (mem_shard < 0) mem_shard = metric_shard();
+    return mem_shards[mem_shard];
 }
 
-void Student::assign_roll() {}
+long long folded_live(MemTag tag) {
+    long long live = 0;
+    for (const auto& s : mem_shards) live += s.live[tag].load(memory_order_relaxed);
+    return live;
+}
 
-void Student::set_admitted(const string& branch) {
-    admitted = true;
-    assigned_branch = branch;
+long long note_peak(MemTag tag) {
+    long long live = folded_live(tag);
+    long long peak = mem_peaks[tag].load(memory_order_relaxed);
+    while (live > peak && !mem_peaks[tag].compare_exchange_weak(peak, live, memory_order_relaxed)) { }
+    return std::max(live, peak);
 }
 
-bool Student::is_admitted() const { return admitted; }
+// Prefix stored right in front of every tracked block. Plain blocks put it
+// at the start of the malloc'd region; over-aligned blocks pad up to the
+// alignment first, and `offset` leads back to the start.
+struct alignas(16) MemBlockHeader {
+    size_t size;
+    uint32_t offset;
+    MemTag tag;
+};
 
-const string& Student::get_name() const { return name; }
-int Student::get_income() const { return income; }
-const vector<string>& Student::get_preferences() const { return preferred_branches; }
-const string& Student::get_gender() const { return gender; }
-const string& Student::get_category() const { return category; }
-int Student::get_roll() const { return roll_number; }
-int Student::get_percentage_12th() const { return percentage_12th; }
-int Student::get_age() const { return age; }
+void* tracked_allocate(size_t size, size_t alignment = sizeof(MemBlockHeader)) {
+    MemTag tag = current_mem_tag;
+    size_t offset = std::max(alignment, sizeof(MemBlockHeader));
+    void* raw = alignment > sizeof(MemBlockHeader)
+        ? aligned_alloc(alignment, (offset + size + alignment - 1) / alignment * alignment)
+        : malloc(offset + size);
+    if (!raw) return nullptr;
+    char* user = static_cast<char*>(raw) + offset;
+    MemBlockHeader* h = reinterpret_cast<MemBlockHeader*>(user) - 1;
+    h->size = size;
+    h->offset = (uint32_t)offset;
+    h->tag = tag;
+    MemoryAccounting::on_allocate(tag, size);
+    return user;
+}
 
-bool Student::scholarship_eligible(int income_threshold, const string& category_pref) const {
-    return (income <= income_threshold) || (category == category_pref);
+void tracked_free(void* p) {
+    if (!p) return;
+    MemBlockHeader* h = static_cast<MemBlockHeader*>(p) - 1;
+    MemoryAccounting::on_free(h->tag, h->size);
+    free(static_cast<char*>(p) - h->offset);
 }
 
-void Student::allocate_hostel() { hostel_allocated = true; }
-bool Student::has_hostel() const { return hostel_allocated; }
+}
 
-void Student::allocate_mess(const string& plan) {
-    mess_allocated = true;
-    mess_plan = plan;
+void* operator new(size_t size) {
+    void* p = tracked_allocate(size);
+    if (!p) throw bad_alloc();
+    return p;
 }
-bool Student::has_mess() const { return mess_allocated; }
-const string& Student::get_mess_plan() const { return mess_plan; }
-ostream operator<<(ostream& out,Student& s1){
-out<< "| " << setw(4) << s1.roll_number << " | "
-         << setw(20) << s1.left << name.substr(0, 19) << " | "
-         << setw(8) << s1.jee_rank << " | "
-         << setw(6) << s1.percentage_12th << "% | "
-         << setw(4) << s1.age << " | "
-         << setw(6) << s1.gender << " | "
-         << setw(6) << s1.category << " | "
-         << setw(12) << (s1.admitted ? s1.assigned_branch : "Not Admitted") << " | "
-         << setw(6) << (s1.hostel_allocated ? "Yes" : "No") << " | "
-         << setw(8) << (s1.mess_allocated ? s1.mess_plan : "No") << " |" << endl;
-    return out;
+
+void* operator new[](size_t size) {
+    void* p = tracked_allocate(size);
+    if (!p) throw bad_alloc();
+    return p;
 }
-Student x;
-void Student::print_details() const {
-    cout << x;
+
+void* operator new(size_t size, align_val_t al) {
+    void* p = tracked_allocate(size, (size_t)al);
+    if (!p) throw bad_alloc();
+    return p;
 }
 
-void Student::print_detailed_info() const {
-    cout << "+-------------------------------------------------------------+" << endl;
-    cout << "|                    STUDENT DETAILED INFO                    |" << endl;
-    cout << "+-------------------------------------------------------------+" << endl;
-    cout << "| Roll Number: " << setw(45) << left << roll_number << "|" << endl;
-    cout << "| Name: " << setw(52) << left << name << "|" << endl;
-    cout << "| JEE Rank: " << setw(48) << left << jee_rank << "|" << endl;
-    cout << "| 12th Percentage: " << setw(40) << left << (to_string(percentage_12th) + "%") << "|" << endl;
-    cout << "| Age: " << setw(53) << left << age << "|" << endl;
-    cout << "| Gender: " << setw(50) << left << gender << "|" << endl;
-    cout << "| Category: " << setw(48) << left << category << "|" << endl;
-    cout << "| Contact: " << setw(49) << left << contact_number << "|" << endl;
-    cout << "| Annual Income: " << setw(43) << left << ("Rs" + to_string(income)) << "|" << endl;
+void* operator new[](size_t size, align_val_t al) {
+    void* p = tracked_allocate(size, (size_t)al);
+    if (!p) throw bad_alloc();
+    return p;
+}
 
-    string eligibility = is_eligible() ? "ELIGIBLE" : "NOT ELIGIBLE";
-    if (!is_eligible()) {
-        if (percentage_12th < 60)
-            eligibility += " (12th% < 60%)";
-        if (age < 17)
-            eligibility += " (Age < 17)";
-    }
-    cout << "| Eligibility: " << setw(45) << left << eligibility << "|" << endl;
+void* operator new(size_t size, const nothrow_t&) noexcept { return tracked_allocate(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return tracked_allocate(size); }
+void operator delete(void* p) noexcept { tracked_free(p); }
+void operator delete[](void* p) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t) noexcept { tracked_free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { tracked_free(p); }
+void operator delete(void* p, align_val_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, align_val_t) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { tracked_free(p); }
 
-    cout << "| Admission: " << setw(47) << left
-         << (admitted ? "ADMITTED - " + assigned_branch : "Not Admitted") << "|" << endl;
+MemTag MemoryAccounting::current_tag() { return current_mem_tag; }
+void MemoryAccounting::set_current_tag(MemTag tag) { current_mem_tag = tag; }
 
-    cout << "| Branch Preferences: " << setw(38) << left;
-    string prefs;
-    for (size_t i = 0; i < preferred_branches.size(); ++i) {
-        if (i > 0) prefs += ", ";
-        prefs += preferred_branches[i];
+void MemoryAccounting::on_allocate(MemTag tag, size_t size) {
+    MemShard& s = this_mem_shard();
+    s.live[tag].fetch_add((long long)size, memory_order_relaxed);
+    s.allocations[tag].fetch_add(1, memory_order_relaxed);
+    if (size >= MEM_LARGE_BLOCK || --mem_peak_countdown == 0) {
+        mem_peak_countdown = MEM_PEAK_SAMPLE;
+        note_peak(tag);
     }
-    cout << prefs << "|" << endl;
-
-    cout << "| Hostel: " << setw(50) << left
-         << (hostel_allocated ? "Allocated" : "Not Allocated") << "|" << endl;
-    cout << "| Mess: " << setw(52) << left
-         << (mess_allocated ? mess_plan + " Plan" : "Not Allocated") << "|" << endl;
-    cout << "+-------------------------------------------------------------+" << endl;
 }
 
-Student::~Student() = default;
-
-Mess::Mess(string name_, int capacity_) :
-    name(std::move(name_)),
-    capacity(capacity_),
-    current_allocations(0)
-{
-    plan_prices = {{"Basic", 2000}, {"Standard", 3000}, {"Premium", 4500}};
+void MemoryAccounting::on_free(MemTag tag, size_t size) {
+    MemShard& s = this_mem_shard();
+    s.live[tag].fetch_sub((long long)size, memory_order_relaxed);
+    s.frees[tag].fetch_add(1, memory_order_relaxed);
 }
 
-bool Mess::allocate_mess(Student& s, const string& plan) {
-    if (current_allocations >= capacity) {
-        cout << "Mess is full! Cannot allocate for " << s.get_name() << endl;
-        return false;
-    }
-
-    if (plan_prices.find(plan) == plan_prices.end()) {
-        cout << "Invalid mess plan: " << plan << " for " << s.get_name() << endl;
-        return false;
-    }
-
-    if (s.has_mess()) {
-        cout << "Student " << s.get_name() << " already has mess allocation!" << endl;
-        return false;
+MemoryUsage MemoryAccounting::usage(MemTag tag) {
+    MemoryUsage u{0, note_peak(tag), 0, 0};
+    for (const auto& s : mem_shards) {
+        u.live_bytes += s.live[tag].load(memory_order_relaxed);
+        u.allocations += s.allocations[tag].load(memory_order_relaxed);
+        u.frees += s.frees[tag].load(memory_order_relaxed);
     }
+    u.peak_bytes = std::max(u.peak_bytes, u.live_bytes);
+    return u;
+}
 
-    if (!s.has_hostel()) {
-        cout << "Student " << s.get_name() << " must have hostel before mess allocation!" << endl;
-        return false;
+void MemoryAccounting::print_report() {
+    printSection("MEMORY BY SUBSYSTEM");
+    cout << setw(12) << left << "Subsystem" << setw(14) << right << "Live bytes"
+         << setw(14) << "Peak bytes" << setw(12) << "Allocs" << setw(12) << "Frees" << left << endl;
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+        MemoryUsage u = usage((MemTag)t);
+        cout << setw(12) << left << MEM_TAG_NAMES[t] << setw(14) << right << u.live_bytes
+             << setw(14) << u.peak_bytes << setw(12) << u.allocations
+             << setw(12) << u.frees << left << endl;
     }
-
-    s.allocate_mess(plan);
-    current_allocations++;
-    cout << "Allocated " << plan << " mess plan to " << s.get_name()
-         << " (Price: Rs" << get_plan_price(plan) << ")" << endl;
-    return true;
 }
 
-bool Mess::is_available() const {
-    return current_allocations < capacity;
+int metric_shard() {
+    static atomic<int> next_shard{0};
+    thread_local int shard = next_shard.fetch_add(1, memory_order_relaxed) % METRIC_SHARDS;
+    return shard;
 }
 
-void Mess::set_plan_price(const string& plan, int price) {
-    plan_prices[plan] = price;
+long long MetricCounter::value() const {
+    long long sum = 0;
+    for (const auto& c : cells) sum += c.value.load(memory_order_relaxed);
+    return sum;
 }
 
-int Mess::get_plan_price(const string& plan) const {
-    auto it = plan_prices.find(plan);
-    return it != plan_prices.end() ? it->second : 0;
+MetricHistogram::Shard::Shard() : sum(0) {
+    for (auto& c : counts) c.store(0, memory_order_relaxed);
 }
 
-void Mess::print_status() const {
-    cout << "+-------------------------------------------------------------+" << endl;
-    cout << "| " << setw(58) << left << ("Mess: " + name) << "|" << endl;
-    cout << "+-------------------------------------------------------------+" << endl;
-    cout << "| Capacity: " << setw(4) << capacity
-         << " | Allocated: " << setw(4) << current_allocations
-         << " | Available: " << setw(4) << (capacity - current_allocations) << " |" << endl;
-
-    cout << "| Plan Prices: ";
-    for (const auto& plan : MESS_PLANS) {
-        auto it = plan_prices.find(plan);
-        if (it != plan_prices.end()) {
-            cout << plan << ": Rs" << it->second << "  ";
-        }
-    }
-    cout << "|" << endl;
-    cout << "+-------------------------------------------------------------+" << endl;
+int MetricHistogram::bucket_of(long long v) {
+    if (v < SUB_BUCKETS) return (int)std::max(0LL, v);
+    v = std::min(v, (1LL << (MAX_EXPONENT + 1)) - 1);
+    int e = 63 - __builtin_clzll((unsigned long long)v);
+    int sub = (int)((v >> (e - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return (e - SUB_BITS + 1) * SUB_BUCKETS + sub;
 }
 
-Mess::~Mess() = default;
+long long MetricHistogram::bucket_upper(int bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    int e = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    long long width = 1LL << (e - SUB_BITS);
+    return (1LL << e) + (bucket % SUB_BUCKETS) * width + width - 1;
+}
 
-Branch::Branch(string name_, int general_seats_, unordered_map<string,int> reserved_,
-               int opening_rank_, int closing_rank_) :
-    name(std::move(name_)),
-    general_seats(std::max(0, general_seats_)),
-    reserved_seats(std::move(reserved_)),
-    opening_rank(std::max(1, opening_rank_)),
-    closing_rank(std::max(1, closing_rank_))
-{
-    if (closing_rank < opening_rank) {
-        closing_rank = opening_rank;
-    }
+void MetricHistogram::record(long long ns) {
+    Shard& sh = shards[metric_shard()];
+    sh.counts[bucket_of(ns)].fetch_add(1, memory_order_relaxed);
+    sh.sum.fetch_add(ns, memory_order_relaxed);
 }
 
-bool Branch::allocate_seat(const Student& s) {
-    if (s.jee_rank < opening_rank || s.jee_rank > closing_rank) {
-        return false;
+void MetricHistogram::merged(vector<long long>& counts, long long& sum, long long& total) const {
+    counts.assign(BUCKETS, 0);
+    sum = 0;
+    total = 0;
+    for (const auto& sh : shards) {
+        for (int i = 0; i < BUCKETS; ++i) counts[i] += sh.counts[i].load(memory_order_relaxed);
+        sum += sh.sum.load(memory_order_relaxed);
     }
+    for (long long c : counts) total += c;
+}
 
-    auto it = reserved_seats.find(s.get_category());
-    if (it != reserved_seats.end() && it->second > 0) {
-        --(it->second);
-        cout << "Allocated " << name << " seat to " << s.get_name()
-             << " under " << s.get_category() << " category" << endl;
-        return true;
+long long MetricHistogram::percentile(double p) const {
+    vector<long long> counts;
+    long long sum, total;
+    merged(counts, sum, total);
+    if (total == 0) return 0;
+    long long target = std::max(1LL, (long long)ceil(p / 100.0 * total));
+    long long seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= target) return bucket_upper(i);
     }
+    return bucket_upper(BUCKETS - 1);
+}
 
-    if (general_seats > 0) {
-        --general_seats;
-        cout << "Allocated " << name << " seat to " << s.get_name()
-             << " under General category" << endl;
-        return true;
+MetricsRegistry::Series& MetricsRegistry::find_or_add(const string& name, const string& labels, const string& help) {
+    lock_guard<mutex> guard(lock);
+    for (auto& s : series) {
+        if (s->name == name && s->labels == labels) return *s;
     }
-
-    return false;
+    series.push_back(make_unique<Series>());
+    Series& s = *series.back();
+    s.name = name;
+    s.labels = labels;
+    s.help = help;
+    return s;
 }
 
-const string& Branch::get_name() const { return name; }
-
-int Branch::seats_total() const {
-    int sum = general_seats;
-    for (const auto &p : reserved_seats) sum += p.second;
-    return sum;
+MetricCounter& MetricsRegistry::counter(const string& name, const string& help, const string& labels) {
+    Series& s = find_or_add(name, labels, help);
+    if (!s.counter) s.counter = make_unique<MetricCounter>();
+    return *s.counter;
 }
 
-int Branch::general_remaining() const { return general_seats; }
-
-int Branch::reserved_remaining(const string& category) const {
-    auto it = reserved_seats.find(category);
-    return it != reserved_seats.end() ? it->second : 0;
+MetricGauge& MetricsRegistry::gauge(const string& name, const string& help, const string& labels) {
+    Series& s = find_or_add(name, labels, help);
+    if (!s.gauge) s.gauge = make_unique<MetricGauge>();
+    return *s.gauge;
 }
 
-const unordered_map<string,int>& Branch::get_reserved_map() const { return reserved_seats; }
+MetricHistogram& MetricsRegistry::histogram(const string& name, const string& help, const string& labels) {
+    Series& s = find_or_add(name, labels, help);
+    if (!s.histogram) s.histogram = make_unique<MetricHistogram>();
+    return *s.histogram;
+}
 
-void Branch::print_seat_status() const {
-    cout << "| " << setw(15) << left << name
-         << "| General: " << setw(3) << general_seats;
+string MetricsRegistry::render_prometheus() const {
+    vector<const Series*> sorted;
+    {
+        lock_guard<mutex> guard(lock);
+        for (const auto& s : series) sorted.push_back(s.get());
+    }
+    stable_sort(sorted.begin(), sorted.end(), [](const Series* a, const Series* b) {
+        return a->name < b->name;
+    });
 
-    for (const auto& cat : CATEGORIES) {
-        int rem = reserved_remaining(cat);
-        if (rem > 0) {
-            cout << "| " << cat << ": " << setw(3) << rem;
+    ostringstream out;
+    string last_name;
+    for (const Series* s : sorted) {
+        string type = s->counter ? "counter" : s->gauge ? "gauge" : "histogram";
+        if (s->name != last_name) {
+            out << "# HELP " << s->name << " " << s->help << "\n";
+            out << "# TYPE " << s->name << " " << type << "\n";
+            last_name = s->name;
+        }
+        string braces = s->labels.empty() ? "" : "{" + s->labels + "}";
+        if (s->counter) {
+            out << s->name << braces << " " << s->counter->value() << "\n";
+        } else if (s->gauge) {
+            out << s->name << braces << " " << s->gauge->value() << "\n";
+        } else if (s->histogram) {
+            vector<long long> counts;
+            long long sum, total;
+            s->histogram->merged(counts, sum, total);
+            string prefix = s->labels.empty() ? "" : s->labels + ",";
+            long long cumulative = 0;
+            // Fine buckets are folded into one Prometheus bucket per power of two
+            for (int i = 0; i < MetricHistogram::BUCKETS; ++i) {
+                cumulative += counts[i];
+                if (i % MetricHistogram::SUB_BUCKETS != MetricHistogram::SUB_BUCKETS - 1) continue;
+                double le = (MetricHistogram::bucket_upper(i) + 1) / 1e9;
+                out << s->name << "_bucket{" << prefix << "le=\"" << le << "\"} " << cumulative << "\n";
+            }
+            out << s->name << "_bucket{" << prefix << "le=\"+Inf\"} " << total << "\n";
+            out << s->name << "_sum" << braces << " " << sum / 1e9 << "\n";
+            out << s->name << "_count" << braces << " " << total << "\n";
         }
     }
-    cout << "| Rank Range: " << opening_rank << "-" << closing_rank << " |" << endl;
+    return out.str();
 }
 
-Branch::~Branch() = default;
-
-Hostel::Hostel(string name_, int rooms) :
-    name(std::move(name_)),
-    total_rooms(std::max(0, rooms)),
-    rooms_allocated(0)
-{ }
-
-bool Hostel::is_available() const {
-    return rooms_allocated < total_rooms;
+bool MetricsRegistry::write_prometheus_file(const string& path) const {
+    string tmp = path + ".tmp";
+    {
+        ofstream out(tmp);
+        if (!out) return false;
+        out << render_prometheus();
+        if (!out) return false;
+    }
+    return rename(tmp.c_str(), path.c_str()) == 0;
 }
 
-void Hostel::print_status() const {
-    cout << "| " << setw(15) << left << name
-         << "| Total: " << setw(4) << total_rooms
-         << "| Allocated: " << setw(4) << rooms_allocated
-         << "| Available: " << setw(4) << (total_rooms - rooms_allocated) << "|" << endl;
+MetricsRegistry& metrics_registry() {
+    static MetricsRegistry registry;
+    return registry;
 }
 
-BoysHostel::BoysHostel(string name_, int rooms) : Hostel(name_, rooms) { }
+MetricsFileExporter::MetricsFileExporter(string path_, chrono::milliseconds interval_) :
+    path(std::move(path_)),
+    interval(std::max(chrono::milliseconds(10), interval_)),
+    running(true)
+{
+    worker = thread([this]() {
+        unique_lock<mutex> guard(wait_lock);
+        while (running) {
+            metrics_registry().write_prometheus_file(path);
+            wake.wait_for(guard, interval, [this]() { return !running; });
+        }
+    });
+}
 
-void BoysHostel::allocate_room(Student& s) {
-    string g = s.get_gender();
-    if (is_available() && (g == "male")) {
-        ++rooms_allocated;
-        s.allocate_hostel();
-        cout << "Allocated boys hostel room to " << s.get_name() << endl;
+MetricsFileExporter::~MetricsFileExporter() {
+    {
+        lock_guard<mutex> guard(wait_lock);
+        running = false;
     }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+    metrics_registry().write_prometheus_file(path);
 }
 
-BoysHostel::~BoysHostel() = default;
+MetricsSocketExporter::MetricsSocketExporter(string path_) :
+    path(std::move(path_)),
+    listen_fd(-1),
+    running(false)
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return;
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) return;
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 16) < 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        return;
+    }
+
+    running = true;
+    worker = thread([this]() {
+        while (running) {
+            pollfd pfd{listen_fd, POLLIN, 0};
+            if (poll(&pfd, 1, 200) <= 0) continue;
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            string body = metrics_registry().render_prometheus();
+            size_t off = 0;
+            while (off < body.size()) {
+                ssize_t n = send(fd, body.data() + off, body.size() - off, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                off += n;
+            }
+            close(fd);
+        }
+    });
+}
 
-GirlsHostel::GirlsHostel(string name_, int rooms) : Hostel(name_, rooms) { }
+bool MetricsSocketExporter::is_listening() const { return listen_fd >= 0; }
 
-void GirlsHostel::allocate_room(Student& s) {
-    string g = s.get_gender();
-    if (is_available() && (g == "female")) {
-        ++rooms_allocated;
-        s.allocate_hostel();
-        cout << "Allocated girls hostel room to " << s.get_name() << endl;
+MetricsSocketExporter::~MetricsSocketExporter() {
+    running = false;
+    if (worker.joinable()) worker.join();
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(path.c_str());
     }
 }
 
-GirlsHostel::~GirlsHostel() = default;
-
-int University::total_admitted_global = 0;
+Tracer::Tracer() :
+    on(false),
+    origin(chrono::steady_clock::now())
+{ }
 
-University::University(string name_, int opening_rank_, int closing_rank_) :
-    name(std::move(name_)),
-    total_seats(0),
-    branches(),
-    admitted_students(),
-    opening_rank(std::max(1, opening_rank_)),
-    closing_rank(std::max(1, closing_rank_))
-{
-    if (closing_rank < opening_rank) {
-        closing_rank = opening_rank;
-    }
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
 }
 
-void University::add_branch(unique_ptr<Branch> b) {
-    if (!b) return;
-    total_seats += b->seats_total();
-    branches.emplace(b->get_name(), std::move(b));
+void Tracer::set_enabled(bool enable) {
+    on.store(enable, memory_order_relaxed);
 }
 
-bool University::can_admit(const Student& s) const {
-    if (s.jee_rank < opening_rank || s.jee_rank > closing_rank) return false;
-    return total_seats > 0;
+long long Tracer::now_ns() const {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
 }
 
-bool University::admit_student(Student& s) {
-    if (s.is_admitted()) return false;
-    if (!s.is_eligible()) return false;
-    if (!can_admit(s)) return false;
+Tracer::ThreadBuffer& Tracer::local_buffer() {
+    thread_local shared_ptr<ThreadBuffer> local;
+    if (!local) {
+        local = make_shared<ThreadBuffer>();
+        lock_guard<mutex> guard(buffers_lock);
+        local->tid = (int)buffers.size() + 1;
+        buffers.push_back(local);
+    }
+    return *local;
+}
 
-    for (const auto & pref : s.get_preferences()) {
-        auto it = branches.find(pref);
-        if (it == branches.end()) continue;
-        Branch* br = it->second.get();
-        if (!br) continue;
-        if (br->allocate_seat(s)) {
-            admitted_students.push_back(&s);
-            s.set_admitted(pref);
-            total_seats -= 1;
-            ++total_admitted_global;
-            return true;
-        }
+void Tracer::record(const char* name, const char* category, long long start_ns, long long duration_ns) {
+    ThreadBuffer& buf = local_buffer();
+    lock_guard<mutex> guard(buf.lock);      // only contended while a trace is written out
+    if (buf.events.size() >= MAX_EVENTS_PER_THREAD) {
+        ++buf.dropped;
+        return;
     }
-    return false;
+    buf.events.push_back({name, category, start_ns, duration_ns});
 }
 
-void University::print_admitted() const {
-    cout << "+-------------------------------------------------------------+" << endl;
-    cout << "| " << setw(58) << left << ("University: " + name) << "|" << endl;
-    cout << "| Admitted Students: " << setw(38) << left << admitted_students.size() << "|" << endl;
-    cout << "| Rank Range: " << setw(44) << left << (to_string(opening_rank) + " - " + to_string(closing_rank)) << "|" << endl;
-    cout << "+-------------------------------------------------------------+" << endl;
+size_t Tracer::event_count() const {
+    lock_guard<mutex> guard(buffers_lock);
+    size_t n = 0;
+    for (const auto& b : buffers) {
+        lock_guard<mutex> bguard(b->lock);
+        n += b->events.size();
+    }
+    return n;
+}
 
-    if (admitted_students.empty()) {
-        cout << "| No students admitted                                              |" << endl;
-    } else {
-        for (const Student* p : admitted_students) {
-            if (p) {
-                string branch = p->is_admitted() ? p->assigned_branch : "Unknown";
-                cout << "| > Roll " << setw(4) << p->get_roll()
-                     << " | " << setw(20) << left << p->get_name().substr(0, 19)
-                     << " | Rank: " << setw(6) << p->jee_rank
-                     << " | Branch: " << setw(12) << left << branch << "|" << endl;
-            }
-        }
+void Tracer::clear() {
+    lock_guard<mutex> guard(buffers_lock);
+    for (const auto& b : buffers) {
+        lock_guard<mutex> bguard(b->lock);
+        b->events.clear();
+        b->dropped = 0;
     }
-    cout << "+-------------------------------------------------------------+" << endl;
 }
 
-void University::print_branch_status() const {
-    cout << "+-------------------------------------------------------------+" << endl;
-    cout << "| " << setw(58) << left << ("Branch Status - " + name) << "|" << endl;
-    cout << "+-------------------------------------------------------------+" << endl;
-    for (const auto& branch : branches) {
-        if (branch.second) {
-            branch.second->print_seat_status();
+bool Tracer::write_chrome_trace(const string& path) const {
+    ofstream out(path);
+    if (!out) return false;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    lock_guard<mutex> guard(buffers_lock);
+    for (const auto& b : buffers) {
+        lock_guard<mutex> bguard(b->lock);
+        for (const auto& e : b->events) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+                << fixed << setprecision(3)
+                << ",\"ts\":" << e.start_ns / 1000.0
+                << ",\"dur\":" << e.duration_ns / 1000.0 << "}";
+        }
+        if (b->dropped) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"dropped_events\",\"ph\":\"C\",\"pid\":1,\"tid\":" << b->tid
+                << ",\"ts\":0,\"args\":{\"dropped\":" << b->dropped << "}}";
         }
     }
-    cout << "+-------------------------------------------------------------+" << endl;
+    out << "\n]}\n";
+    return (bool)out;
 }
 
-const unordered_map<string, unique_ptr<Branch>>& University::get_branches() const { return branches; }
-const string& University::get_name() const { return name; }
-int University::get_admitted_count() const { return admitted_students.size(); }
+TraceSpan::TraceSpan(const char* name_, const char* category_) :
+    name(name_),
+    category(category_),
+    start_ns(Tracer::instance().enabled() ? Tracer::instance().now_ns() : -1)
+{ }
 
-University::~University() = default;
+TraceSpan::~TraceSpan() {
+    if (start_ns < 0) return;
+    Tracer& t = Tracer::instance();
+    t.record(name, category, start_ns, t.now_ns() - start_ns);
+}
 
-AdmissionOffice::AdmissionOffice() :
-    universities(),
-    boys_hostel(nullptr),
-    girls_hostel(nullptr),
-    mess(nullptr)
-{ }
+static const string GENDER_NAMES[] = {"male", "female"};
 
-void AdmissionOffice::add_university(unique_ptr<University> u) {
-    if (!u) return;
-    universities.push_back(std::move(u));
+Gender parse_gender(string g) {
+    transform(g.begin(), g.end(), g.begin(), ::tolower);
+    return (g == "female" || g == "f") ? Gender::Female : Gender::Male;
 }
 
-void AdmissionOffice::set_hostels(unique_ptr<BoysHostel> b, unique_ptr<GirlsHostel> g) {
-    boys_hostel = std::move(b);
-    girls_hostel = std::move(g);
+Category parse_category(const string& c) {
+    auto it = find(CATEGORIES.begin(), CATEGORIES.end(), c);
+    return it == CATEGORIES.end() ? Category::General : (Category)(it - CATEGORIES.begin());
 }
 
-void AdmissionOffice::set_mess(unique_ptr<Mess> m) {
-    mess = std::move(m);
+bool parse_mess_plan(const string& p, MessPlan& out) {
+    auto it = find(MESS_PLANS.begin(), MESS_PLANS.end(), p);
+    if (it == MESS_PLANS.end()) return false;
+    out = (MessPlan)(it - MESS_PLANS.begin());
+    return true;
 }
 
-void AdmissionOffice::process_applications(vector<Student>& applicants) {
-    sort(applicants.begin(), applicants.end(), [](const Student& a, const Student& b){
-        return a.jee_rank < b.jee_rank;
-    });
+const string& gender_name(Gender g) { return GENDER_NAMES[(int)g]; }
+const string& category_name(Category c) { return CATEGORIES[(int)c]; }
+const string& mess_plan_name(MessPlan p) { return MESS_PLANS[(int)p]; }
 
-    cout << "\nProcessing " << applicants.size() << " applications..." << endl;
+namespace {
 
-    for (auto & student : applicants) {
-        if (!student.is_eligible()) {
-            cout << "Skipping " << student.get_name() << " - Not eligible" << endl;
-            continue;
-        }
+struct BranchNameTable {
+    mutex lock;
+    deque<string> names;
+    unordered_map<string, BranchId> ids;
+};
 
-        bool admitted = false;
-        for (auto & uni_ptr : universities) {
-            if (!uni_ptr) continue;
+BranchNameTable& branch_names() {
+    static BranchNameTable table;
+    return table;
+}
 
-            if (uni_ptr->admit_student(student)) {
-                admitted = true;
-                cout << "Admitted " << student.get_name() << " to "
-                     << uni_ptr->get_name() << endl;
+}
 
-                string g = student.get_gender();
+BranchId intern_branch(const string& name) {
+    BranchNameTable& t = branch_names();
+    lock_guard<mutex> guard(t.lock);
+    auto it = t.ids.find(name);
+    if (it != t.ids.end()) return it->second;
+    if (t.names.size() >= NO_BRANCH) return NO_BRANCH;
+    BranchId id = (BranchId)t.names.size();
+    t.names.push_back(name);
+    t.ids.emplace(name, id);
+    return id;
+}
 
-                if (g == "male" && boys_hostel) {
-                    boys_hostel->allocate_room(student);
-                } else if (g == "female" && girls_hostel) {
-                    girls_hostel->allocate_room(student);
-                }
+BranchId find_branch_id(const string& name) {
+    BranchNameTable& t = branch_names();
+    lock_guard<mutex> guard(t.lock);
+    auto it = t.ids.find(name);
+    return it != t.ids.end() ? it->second : NO_BRANCH;
+}
 
-                if (student.has_hostel() && mess) {
-                    string mess_plan = "Standard";
+const string& branch_name(BranchId id) {
+    static const string none;
+    BranchNameTable& t = branch_names();
+    lock_guard<mutex> guard(t.lock);
+    return id < t.names.size() ? t.names[id] : none;
+}
 
-                    if (student.get_income() <= 100000 ||
-                        student.get_category() == "SC" ||
-                        student.get_category() == "ST") {
-                        mess_plan = "Basic";
-                    }
-                    else if (student.get_income() > 500000) {
-                        mess_plan = "Premium";
-                    }
+namespace {
 
-                    mess->allocate_mess(student, mess_plan);
-                }
-                break;
+struct ProgramTable {
+    struct Entry {
+        string university;
+        BranchId branch;
+    };
+    mutex lock;
+    deque<Entry> programs;
+    unordered_map<string, ProgramId> ids;    // keyed by "University / Branch"
+    unordered_set<string> universities;
+};
+
+ProgramTable& program_table() {
+    static ProgramTable table;
+    return table;
+}
+
+string trim_spaces(const string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == string::npos) return string();
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+}
+
+void register_university(const string& name) {
+    ProgramTable& t = program_table();
+    lock_guard<mutex> guard(t.lock);
+    t.universities.insert(name);
+}
+
+ProgramId intern_program(const string& spec) {
+    string university, branch;
+    size_t sep = spec.rfind('/');
+    if (sep == string::npos) branch = trim_spaces(spec);
+    else {
+        university = trim_spaces(spec.substr(0, sep));
+        branch = trim_spaces(spec.substr(sep + 1));
+    }
+    if (branch.empty()) return NO_PROGRAM;
+    BranchId b = find_branch_id(branch);
+    if (b == NO_BRANCH) return UNKNOWN_PROGRAM;
+    string key = university.empty() ? branch : university + " / " + branch;
+
+    ProgramTable& t = program_table();
+    lock_guard<mutex> guard(t.lock);
+    auto it = t.ids.find(key);
+    if (it != t.ids.end()) return it->second;
+    if (!university.empty() && !t.universities.count(university)) return UNKNOWN_PROGRAM;
+    if (t.programs.size() >= UNKNOWN_PROGRAM) return UNKNOWN_PROGRAM;
+    ProgramId id = (ProgramId)t.programs.size();
+    t.programs.push_back({std::move(university), b});
+    t.ids.emplace(std::move(key), id);
+    return id;
+}
+
+size_t program_count() {
+    ProgramTable& t = program_table();
+    lock_guard<mutex> guard(t.lock);
+    return t.programs.size();
+}
+
+const string& program_university(ProgramId id) {
+    static const string none;
+    ProgramTable& t = program_table();
+    lock_guard<mutex> guard(t.lock);
+    return id < t.programs.size() ? t.programs[id].university : none;
+}
+
+BranchId program_branch(ProgramId id) {
+    ProgramTable& t = program_table();
+    lock_guard<mutex> guard(t.lock);
+    return id < t.programs.size() ? t.programs[id].branch : NO_BRANCH;
+}
+
+string program_name(ProgramId id) {
+    if (id == UNKNOWN_PROGRAM) return "(not offered)";
+    const string& university = program_university(id);
+    if (university.empty()) return branch_name(program_branch(id));
+    return university + " / " + branch_name(program_branch(id));
+}
+
+namespace {
+
+// The chunk or slab this thread is filling, valid while owner and
+// generation still match.
+struct PoolCursor {
+    const StringPool* owner = nullptr;
+    uint64_t generation = 0;
+    uint32_t chunk = 0;
+    uint32_t used = StringPool::CHUNK_SIZE;
+};
+
+struct ArenaSlab {
+    const RunArena* owner = nullptr;
+    uint64_t generation = 0;
+    char* next = nullptr;
+    char* end = nullptr;
+};
+
+thread_local PoolCursor pool_cursor;
+thread_local ArenaSlab arena_slab;
+
+}
+
+StringPool::StringPool(pmr::memory_resource* upstream_) :
+    upstream(upstream_),
+    chunks(),
+    chunk_count(0),
+    generation(0),
+    spare(nullptr),
+    bytes(0)
+{ }
+
+uint32_t StringPool::take_chunk(uint64_t& chunk_generation) {
+    lock_guard<mutex> guard(lock);
+    uint32_t index = chunk_count.load(memory_order_relaxed);
+    if (index == MAX_CHUNKS) throw length_error("applicant string pool exhausted");
+    chunks[index] = spare ? spare : static_cast<char*>(upstream->allocate(CHUNK_SIZE, 1));
+    spare = nullptr;
+    bytes.fetch_add(CHUNK_SIZE, memory_order_relaxed);
+    chunk_count.store(index + 1, memory_order_release);
+    chunk_generation = generation.load(memory_order_relaxed);
+    return index;
+}
+
+uint32_t StringPool::add(string_view str, uint8_t& length) {
+    str = str.substr(0, MAX_LENGTH);
+    length = (uint8_t)str.size();
+    PoolCursor& c = pool_cursor;
+    if (c.owner != this || c.generation != generation.load(memory_order_acquire) ||
+        c.used + str.size() > CHUNK_SIZE) {
+        c.owner = this;
+        c.chunk = take_chunk(c.generation);
+        c.used = 0;
+    }
+    uint32_t ref = (c.chunk << CHUNK_BITS) | c.used;
+    memcpy(chunks[c.chunk] + c.used, str.data(), str.size());
+    c.used += (uint32_t)str.size();
+    return ref;
+}
+
+StringPool::Mark StringPool::mark() const {
+    const PoolCursor& c = pool_cursor;
+    bool current = c.owner == this && c.generation == generation.load(memory_order_acquire);
+    return Mark{chunk_count.load(memory_order_acquire), current ? c.chunk : 0, current ? c.used : CHUNK_SIZE};
+}
+
+// Drops everything this thread added since `m`, so a caller that creates
+// and discards applicants one at a time does not grow the pool. No other
+// thread may add in between. References taken after the mark become
+// invalid.
+void StringPool::rewind(Mark m) {
+    lock_guard<mutex> guard(lock);
+    uint32_t count = chunk_count.load(memory_order_relaxed);
+    while (count > m.chunks) {
+        spare = chunks[--count];
+        bytes.fetch_sub(CHUNK_SIZE, memory_order_relaxed);
+    }
+    chunk_count.store(count, memory_order_release);
+    PoolCursor& c = pool_cursor;
+    c.owner = this;
+    c.generation = generation.load(memory_order_relaxed);
+    c.chunk = m.thread_chunk;
+    c.used = m.used_in_chunk;
+}
+
+// Forgets every string; the chunk memory itself is reclaimed by the owner.
+void StringPool::reset() {
+    lock_guard<mutex> guard(lock);
+    chunk_count.store(0, memory_order_relaxed);
+    spare = nullptr;
+    bytes.store(0, memory_order_relaxed);
+    generation.fetch_add(1, memory_order_release);
+}
+
+RunArena::RunArena() :
+    arena(64 * 1024),
+    pool(this),
+    reserved(0),
+    generation(0)
+{ }
+
+void* RunArena::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes <= SLAB_SIZE / 16 && alignment <= alignof(max_align_t)) {
+        ArenaSlab& s = arena_slab;
+        if (s.owner == this && s.generation == generation.load(memory_order_acquire)) {
+            char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(s.next) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+            if (p + bytes <= s.end) {
+                s.next = p + bytes;
+                return p;
+            }
+        }
+        lock_guard<mutex> guard(lock);
+        MemoryScope mem(MEM_APPLICANTS);
+        s.owner = this;
+        s.generation = generation.load(memory_order_relaxed);
+        s.next = static_cast<char*>(arena.allocate(SLAB_SIZE, alignof(max_align_t)));
+        s.end = s.next + SLAB_SIZE;
+        reserved.fetch_add(SLAB_SIZE, memory_order_relaxed);
+        char* p = s.next;
+        s.next += bytes;
+        return p;
+    }
+    lock_guard<mutex> guard(lock);
+    MemoryScope mem(MEM_APPLICANTS);
+    reserved.fetch_add(bytes, memory_order_relaxed);
+    return arena.allocate(bytes, alignment);
+}
+
+void RunArena::release() {
+    pool.reset();
+    lock_guard<mutex> guard(lock);
+    arena.release();
+    reserved.store(0, memory_order_relaxed);
+    generation.fetch_add(1, memory_order_release);
+}
+
+RunArena& run_arena() {
+    static RunArena arena;
+    return arena;
+}
+
+StringPool& applicant_strings() {
+    return run_arena().strings();
+}
+
+static thread_local pmr::memory_resource* current_spill = nullptr;
+
+pmr::memory_resource& spill_resource() {
+    return current_spill ? *current_spill : run_arena();
+}
+
+SpillScope::SpillScope(pmr::memory_resource& scratch) : previous(current_spill) {
+    current_spill = &scratch;
+}
+
+SpillScope::~SpillScope() { current_spill = previous; }
+
+atomic<int> RollAllocator::next_free{1};
+
+int RollAllocator::next() {
+    thread_local int cursor = 0, limit = 0;
+    if (cursor == limit) {
+        cursor = next_free.fetch_add(BLOCK, memory_order_relaxed);
+        limit = cursor + BLOCK;
+    }
+    return cursor++;
+}
+
+int RollAllocator::reserve(int count) {
+    return next_free.fetch_add(std::max(0, count), memory_order_relaxed);
+}
+
+Student::Student(string name_,
+                 int income_,
+                 int jee_rank_,
+                 vector<string> preferences_,
+                 string contact_number_,
+                 int percentage_12th_,
+                 int age_,
+                 string gender_,
+                 string category_,
+                 int roll) :
+    roll_number(roll > 0 ? roll : RollAllocator::next()),
+    income(std::max(0, income_)),
+    name_ref(0),
+    contact_ref(0),
+    name_length(0),
+    contact_length(0),
+    age((uint8_t)std::max(0, std::min(255, age_))),
+    percentage_12th((uint8_t)std::max(0, std::min(100, percentage_12th_))),
+    gender((uint16_t)parse_gender(std::move(gender_))),
+    category((uint16_t)parse_category(category_)),
+    mess_plan(0),
+    admitted(false),
+    hostel_allocated(false),
+    mess_allocated(false),
+    ranked_programs(false),
+    mess_outlet(0),
+    assigned_branch(NO_BRANCH),
+    preferred_programs(),
+    hostel_bed(NO_BED),
+    jee_rank(std::max(1, jee_rank_))
+{
+    name_ref = applicant_strings().add(name_, name_length);
+    contact_ref = applicant_strings().add(contact_number_, contact_length);
+    preferred_programs.reserve(preferences_.size());
+    for (const auto& pref : preferences_) {
+        ProgramId id = intern_program(pref);
+        if (id == NO_PROGRAM) continue;
+        preferred_programs.push_back(id);
+        if (pref.find('/') != string::npos) ranked_programs = true;
+    }
+}
+
+bool Student::is_eligible(int min_percentage_12th, int min_age) const {
+    return (percentage_12th >= min_percentage_12th) && (age >= min_age);
+}
+
+void Student::assign_roll(int roll) { roll_number = roll; }
+
+void Student::set_admitted(BranchId branch) {
+    admitted = true;
+    assigned_branch = branch;
+}
+
+bool Student::is_admitted() const { return admitted; }
+
+string_view Student::get_name() const { return applicant_strings().get(name_ref, name_length); }
+string_view Student::get_contact_number() const { return applicant_strings().get(contact_ref, contact_length); }
+int Student::get_income() const { return income; }
+
+vector<string> Student::get_preferences() const {
+    vector<string> out;
+    out.reserve(preferred_programs.size());
+    for (ProgramId id : preferred_programs) out.push_back(program_name(id));
+    return out;
+}
+
+const SmallVector<ProgramId, 4>& Student::get_preference_ids() const { return preferred_programs; }
+bool Student::has_ranked_programs() const { return ranked_programs; }
+const string& Student::get_gender() const { return gender_name((Gender)gender); }
+Gender Student::get_gender_code() const { return (Gender)gender; }
+const string& Student::get_category() const { return category_name((Category)category); }
+Category Student::get_category_code() const { return (Category)category; }
+BranchId Student::get_assigned_branch_id() const { return assigned_branch; }
+const string& Student::get_assigned_branch() const { return branch_name(assigned_branch); }
+int Student::get_roll() const { return roll_number; }
+int Student::get_percentage_12th() const { return percentage_12th; }
+int Student::get_age() const { return age; }
+
+bool Student::scholarship_eligible(int income_threshold, const string& category_pref) const {
+    return (income <= income_threshold) || (get_category() == category_pref);
+}
+
+void Student::allocate_hostel(uint32_t bed) {
+    hostel_allocated = true;
+    hostel_bed = bed;
+}
+void Student::release_hostel() {
+    hostel_allocated = false;
+    hostel_bed = NO_BED;
+}
+bool Student::has_hostel() const { return hostel_allocated; }
+uint32_t Student::get_hostel_bed() const { return hostel_bed; }
+
+void Student::allocate_mess(MessPlan plan, int outlet) {
+    mess_allocated = true;
+    mess_plan = (uint16_t)plan;
+    mess_outlet = (uint16_t)outlet;
+}
+bool Student::has_mess() const { return mess_allocated; }
+int Student::get_mess_outlet() const { return mess_outlet; }
+
+const string& Student::get_mess_plan() const {
+    static const string none;
+    return mess_allocated ? mess_plan_name((MessPlan)mess_plan) : none;
+}
+MessPlan Student::get_mess_plan_code() const { return (MessPlan)mess_plan; }
+
+void Student::print_details() const {
+    cout << "| " << setw(5) << left << roll_number << " | "
+         << setw(20) << left << get_name().substr(0, 19) << " | "
+         << setw(6) << jee_rank << " | "
+         << setw(6) << (to_string(percentage_12th) + "%") << " | "
+         << setw(4) << (int)age << " | "
+         << setw(6) << get_gender() << " | "
+         << setw(8) << get_category() << " | "
+         << setw(12) << (admitted ? get_assigned_branch().substr(0, 12) : "Not Admitted") << " | "
+         << setw(6) << (hostel_allocated ? "Yes" : "No") << " | "
+         << setw(8) << (mess_allocated ? get_mess_plan() : "No") << " |" << endl;
+}
+
+void Student::print_detailed_info() const {
+    cout << "+-------------------------------------------------------------+" << endl;
+    cout << "|                    STUDENT DETAILED INFO                    |" << endl;
+    cout << "+-------------------------------------------------------------+" << endl;
+    cout << "| Roll Number: " << setw(45) << left << roll_number << "|" << endl;
+    cout << "| Name: " << setw(52) << left << get_name() << "|" << endl;
+    cout << "| JEE Rank: " << setw(48) << left << jee_rank << "|" << endl;
+    cout << "| 12th Percentage: " << setw(40) << left << (to_string(percentage_12th) + "%") << "|" << endl;
+    cout << "| Age: " << setw(53) << left << (int)age << "|" << endl;
+    cout << "| Gender: " << setw(50) << left << get_gender() << "|" << endl;
+    cout << "| Category: " << setw(48) << left << get_category() << "|" << endl;
+    cout << "| Contact: " << setw(49) << left << get_contact_number() << "|" << endl;
+    cout << "| Annual Income: " << setw(43) << left << ("Rs" + to_string(income)) << "|" << endl;
+
+    string eligibility = is_eligible() ? "ELIGIBLE" : "NOT ELIGIBLE";
+    if (!is_eligible()) {
+        if (percentage_12th < 60)
+            eligibility += " (12th% < 60%)";
+        if (age < 17)
+            eligibility += " (Age < 17)";
+    }
+    cout << "| Eligibility: " << setw(45) << left << eligibility << "|" << endl;
+
+    cout << "| Admission: " << setw(47) << left
+         << (admitted ? "ADMITTED - " + get_assigned_branch() : "Not Admitted") << "|" << endl;
+
+    cout << "| Branch Preferences: " << setw(38) << left;
+    string prefs;
+    for (size_t i = 0; i < preferred_programs.size(); ++i) {
+        if (i > 0) prefs += ", ";
+        prefs += program_name(preferred_programs[i]);
+    }
+    cout << prefs << "|" << endl;
+
+    cout << "| Hostel: " << setw(50) << left
+         << (hostel_allocated ? "Allocated" : "Not Allocated") << "|" << endl;
+    cout << "| Mess: " << setw(52) << left
+         << (mess_allocated ? get_mess_plan() + " Plan" : "Not Allocated") << "|" << endl;
+    cout << "+-------------------------------------------------------------+" << endl;
+}
+
+Student::~Student() = default;
+
+namespace {
+atomic<uint64_t> next_store_generation{1};
+}
+
+ApplicantStore::ApplicantStore() :
+    students(),
+    order(),
+    generation(next_store_generation.fetch_add(1, memory_order_relaxed))
+{ }
+
+void ApplicantStore::clear() {
+    students.clear();
+    order.clear();
+    generation = next_store_generation.fetch_add(1, memory_order_relaxed);
+}
+
+// Reorders the listing only; handles (and therefore every roster that
+// holds them) are unaffected.
+void ApplicantStore::sort_by_rank() {
+    stable_sort(order.begin(), order.end(), [this](ApplicantHandle a, ApplicantHandle b) {
+        return students[a].jee_rank < students[b].jee_rank;
+    });
+}
+
+// Removes the most recently added applicant; the listing must not have
+// been reordered since it was added, and no roster may hold its handle,
+// as the next emplace_back gets it again.
+void ApplicantStore::pop_back() {
+    students.pop_back();
+    order.pop_back();
+}
+
+// `listing` must be a permutation of the current handles.
+void ApplicantStore::set_order(vector<ApplicantHandle> listing) {
+    order = std::move(listing);
+}
+
+// Lines are parsed on the calling thread; building the students, which
+// interns names and preferences, is what runs in parallel.
+bool ApplicantStore::load_csv(const string& path, size_t& skipped, string& error, unsigned threads) {
+    ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    vector<ApplicantRecord> records;
+    ApplicantRecord rec;
+    string line;
+    size_t line_no = 0;
+    skipped = 0;
+    while (getline(in, line)) {
+        ++line_no;
+        if (line.empty() || (line_no == 1 && line.compare(0, 4, "name") == 0)) continue;
+        if (rec.parse_csv(line)) records.push_back(rec);
+        else ++skipped;
+    }
+    load_parallel(records.size(), [&records](size_t i, int roll) { return records[i].make(roll); }, threads);
+    return true;
+}
+
+namespace {
+
+thread_local ostream* run_log_sink = nullptr;
+
+}
+
+ostream& run_log() {
+    return run_log_sink ? *run_log_sink : cout;
+}
+
+RunLogScope::RunLogScope(ostream& sink) : previous(run_log_sink) {
+    run_log_sink = &sink;
+}
+
+RunLogScope::~RunLogScope() {
+    run_log_sink = previous;
+}
+
+AdmissionStats::AdmissionStats() :
+    applicants(0),
+    eligible(0),
+    admitted(0),
+    hostel_allocated(0),
+    mess_allocated(0),
+    generation(0)
+{
+    applicant_ranks.fill(0);
+    admitted_ranks.fill(0);
+}
+
+int AdmissionStats::rank_bucket(int rank) {
+    int bucket = 0;
+    for (unsigned r = std::max(1, rank); r > 1; r >>= 1) ++bucket;
+    return std::min(bucket, RANK_BUCKETS - 1);
+}
+
+// Every counter describes one ApplicantStore generation; a store that was
+// cleared (or another store) starts them all from zero.
+void AdmissionStats::follow(uint64_t store_generation) {
+    if (store_generation == generation) return;
+    *this = AdmissionStats();
+    generation = store_generation;
+}
+
+// Applicant-side counters describe the current run only; admission-side
+// counters keep accumulating since students are never admitted twice.
+void AdmissionStats::begin_run(uint64_t store_generation) {
+    follow(store_generation);
+    applicants = 0;
+    eligible = 0;
+    applicant_ranks.fill(0);
+}
+
+void AdmissionStats::record_applicant(const Student& s) {
+    ++applicants;
+    if (s.is_eligible()) ++eligible;
+    ++applicant_ranks[rank_bucket(s.jee_rank)];
+}
+
+void AdmissionStats::record_admission(const Student& s, const string& university) {
+    ++admitted;
+    ++admitted_by_university[university];
+    ++admitted_by_branch[university + " / " + s.get_assigned_branch()];
+    ++admitted_by_category[s.get_category()];
+    ++admitted_by_gender[s.get_gender()];
+    ++admitted_ranks[rank_bucket(s.jee_rank)];
+}
+
+void AdmissionStats::record_hostel(const Student&, const string& hostel) {
+    ++hostel_allocated;
+    ++hostel_by_name[hostel];
+}
+
+void AdmissionStats::record_mess(const Student&, const string& plan) {
+    ++mess_allocated;
+    ++mess_by_plan[plan];
+}
+
+size_t AdmissionStats::count(const unordered_map<string, size_t>& m, const string& key) const {
+    auto it = m.find(key);
+    return it != m.end() ? it->second : 0;
+}
+
+void AdmissionStats::print_summary() const {
+    printSection("ADMISSION STATISTICS");
+    cout << "Applicants (last run): " << applicants << " | Eligible: " << eligible << endl;
+    cout << "Admitted: " << admitted << " | Hostel: " << hostel_allocated
+         << " | Mess: " << mess_allocated << endl;
+
+    cout << "By category: ";
+    for (const auto& cat : CATEGORIES) cout << cat << "=" << count(admitted_by_category, cat) << "  ";
+    cout << endl;
+    cout << "By gender: male=" << count(admitted_by_gender, "male")
+         << "  female=" << count(admitted_by_gender, "female") << endl;
+    cout << "By mess plan: ";
+    for (const auto& plan : MESS_PLANS) cout << plan << "=" << count(mess_by_plan, plan) << "  ";
+    cout << endl;
+
+    cout << "Admitted rank histogram:" << endl;
+    for (int i = 0; i < RANK_BUCKETS; ++i) {
+        if (admitted_ranks[i] == 0) continue;
+        long long lo = 1LL << i, hi = (1LL << (i + 1)) - 1;
+        cout << "  " << setw(10) << right << lo << " - " << setw(10) << left << hi
+             << ": " << admitted_ranks[i] << endl;
+    }
+}
+
+static MetricCounter& mess_allocated_metric =
+    metrics_registry().counter("admission_mess_allocations_total", "Mess plans allocated");
+static MetricCounter& mess_rejected_metric =
+    metrics_registry().counter("admission_mess_rejections_total", "Mess allocation requests refused");
+static MetricGauge& mess_free_metric =
+    metrics_registry().gauge("admission_mess_places_free", "Unallocated mess places");
+
+Mess::Mess(string name_, int capacity_) :
+    name(std::move(name_)),
+    capacity(capacity_),
+    current_allocations(0),
+    outlet(0)
+{
+    plan_prices = {{"Basic", 2000}, {"Standard", 3000}, {"Premium", 4500}};
+    mess_free_metric.add(std::max(0, capacity));
+}
+
+bool Mess::allocate_mess(Student& s, const string& plan) {
+    MessPlan code;
+    if (!parse_mess_plan(plan, code)) {
+        mess_rejected_metric.inc();
+        run_log() << "Invalid mess plan: " << plan << " for " << s.get_name() << endl;
+        return false;
+    }
+    return allocate_mess(s, code);
+}
+
+bool Mess::allocate_mess(Student& s, MessPlan code) {
+    const string& plan = mess_plan_name(code);
+    if (current_allocations >= capacity) {
+        run_log() << "Mess is full! Cannot allocate for " << s.get_name() << endl;
+        mess_rejected_metric.inc();
+        return false;
+    }
+
+    if (plan_prices.find(plan) == plan_prices.end()) {
+        run_log() << "Invalid mess plan: " << plan << " for " << s.get_name() << endl;
+        mess_rejected_metric.inc();
+        return false;
+    }
+
+    if (s.has_mess()) {
+        run_log() << "Student " << s.get_name() << " already has mess allocation!" << endl;
+        mess_rejected_metric.inc();
+        return false;
+    }
+
+    s.allocate_mess(code, outlet);
+    current_allocations++;
+    mess_allocated_metric.inc();
+    mess_free_metric.add(-1);
+    run_log() << "Allocated " << plan << " mess plan to " << s.get_name()
+         << " (Price: Rs" << get_plan_price(plan) << ")" << endl;
+    return true;
+}
+
+bool Mess::is_available() const {
+    return current_allocations < capacity;
+}
+
+bool Mess::offers(MessPlan plan) const {
+    return plan_prices.count(mess_plan_name(plan)) != 0;
+}
+
+void Mess::set_plan_price(const string& plan, int price) {
+    plan_prices[plan] = price;
+}
+
+void Mess::remove_plan(const string& plan) {
+    plan_prices.erase(plan);
+}
+
+int Mess::get_plan_price(const string& plan) const {
+    auto it = plan_prices.find(plan);
+    return it != plan_prices.end() ? it->second : 0;
+}
+
+MessView Mess::view() const {
+    return MessView{name, capacity, current_allocations, plan_prices};
+}
+
+void Mess::print_status() const {
+    view().print_status();
+}
+
+void MessView::print_status() const {
+    cout << "+-------------------------------------------------------------+" << endl;
+    cout << "| " << setw(58) << left << ("Mess: " + name) << "|" << endl;
+    cout << "+-------------------------------------------------------------+" << endl;
+    cout << "| Capacity: " << setw(4) << capacity
+         << " | Allocated: " << setw(4) << current_allocations
+         << " | Available: " << setw(4) << (capacity - current_allocations) << " |" << endl;
+
+    cout << "| Plan Prices: ";
+    for (const auto& plan : MESS_PLANS) {
+        auto it = plan_prices.find(plan);
+        if (it != plan_prices.end()) {
+            cout << plan << ": Rs" << it->second << "  ";
+        }
+    }
+    cout << "|" << endl;
+    cout << "+-------------------------------------------------------------+" << endl;
+}
+
+Mess::~Mess() {
+    mess_free_metric.add(-std::max(0, capacity - current_allocations));
+}
+
+bool MessPlanRule::matches(Category c, bool resident, int income) const {
+    if (categories && !(categories & (1u << (int)c))) return false;
+    if (income < min_income || income > max_income) return false;
+    return residence == MessResidence::Any || (residence == MessResidence::Hostel) == resident;
+}
+
+MessPlanRules::MessPlanRules() : MessPlanRules(standard()) { }
+
+MessPlanRules::MessPlanRules(vector<MessPlanRule> rules_) :
+    rules(std::move(rules_)),
+    steps()
+{
+    compile();
+}
+
+// Basic up to Rs 1 lakh and for SC/ST, Premium above Rs 5 lakh, Standard
+// otherwise; hostel residents and day scholars alike.
+vector<MessPlanRule> MessPlanRules::standard() {
+    const uint8_t sc_st = (1u << (int)Category::SC) | (1u << (int)Category::ST);
+    return {
+        {0, 0, 100000, MessResidence::Any, (int)MessPlan::Basic},
+        {sc_st, 0, INT_MAX, MessResidence::Any, (int)MessPlan::Basic},
+        {0, 500001, INT_MAX, MessResidence::Any, (int)MessPlan::Premium},
+        {0, INT_MIN, INT_MAX, MessResidence::Any, (int)MessPlan::Standard},
+    };
+}
+
+// The rule edges cut the income axis into intervals on which the same
+// rules match, so the first match at an interval's upper end holds for
+// all of it. Neighbouring intervals with the same plan are merged.
+void MessPlanRules::compile() {
+    vector<int> edges{INT_MAX};
+    for (const MessPlanRule& r : rules) {
+        if (r.min_income > INT_MIN) edges.push_back(r.min_income - 1);
+        edges.push_back(r.max_income);
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    for (int c = 0; c < CATEGORY_COUNT; ++c) {
+        for (int resident = 0; resident < 2; ++resident) {
+            vector<Step>& out = steps[c * 2 + resident];
+            out.clear();
+            for (int edge : edges) {
+                int plan = NO_MESS_PLAN;
+                for (const MessPlanRule& r : rules) {
+                    if (r.matches((Category)c, resident, edge)) {
+                        plan = r.plan;
+                        break;
+                    }
+                }
+                if (!out.empty() && out.back().plan == plan) out.back().max_income = edge;
+                else out.push_back({edge, plan});
+            }
+        }
+    }
+}
+
+int MessPlanRules::decide(const Student& s) const {
+    const vector<Step>& table = steps[(int)s.get_category_code() * 2 + (s.has_hostel() ? 1 : 0)];
+    int income = s.get_income();
+    auto it = lower_bound(table.begin(), table.end(), income,
+                          [](const Step& step, int v) { return step.max_income < v; });
+    return it->plan;
+}
+
+static MetricCounter& seat_probes_metric =
+    metrics_registry().counter("admission_branch_seat_probes_total", "Branch::allocate_seat calls");
+static MetricCounter& rank_window_reject_metric =
+    metrics_registry().counter("admission_branch_rank_window_rejects_total", "Seat probes outside the branch rank window");
+static MetricCounter& reserved_seat_metric =
+    metrics_registry().counter("admission_branch_seats_allocated_total", "Branch seats allocated", "quota=\"reserved\"");
+static MetricCounter& general_seat_metric =
+    metrics_registry().counter("admission_branch_seats_allocated_total", "Branch seats allocated", "quota=\"general\"");
+static MetricCounter& supernumerary_seat_metric =
+    metrics_registry().counter("admission_branch_seats_allocated_total", "Branch seats allocated", "quota=\"supernumerary\"");
+static MetricGauge& seats_remaining_metric =
+    metrics_registry().gauge("admission_branch_seats_remaining", "Unallocated seats across all branches");
+
+Branch::Branch(string name_, int general_seats_, unordered_map<string,int> reserved_,
+               int opening_rank_, int closing_rank_) :
+    name(std::move(name_)),
+    id(intern_branch(name)),
+    general_seats(std::max(0, general_seats_)),
+    reserved_seats(std::move(reserved_)),
+    reserved_by_category(),
+    general_cutoff(0),
+    reserved_cutoff(),
+    opening_rank(std::max(1, opening_rank_)),
+    closing_rank(std::max(1, closing_rank_))
+{
+    if (closing_rank < opening_rank) {
+        closing_rank = opening_rank;
+    }
+    for (int c = 0; c < CATEGORY_COUNT; ++c) {
+        auto it = reserved_seats.find(CATEGORIES[c]);
+        reserved_by_category[c] = it != reserved_seats.end() ? &it->second : nullptr;
+    }
+    seats_remaining_metric.add(seats_total());
+}
+
+// Counts the probe and checks the rank window.
+bool Branch::enter(const Student& s) {
+    seat_probes_metric.inc();
+    if (s.jee_rank < opening_rank || s.jee_rank > closing_rank) {
+        rank_window_reject_metric.inc();
+        return false;
+    }
+    return true;
+}
+
+SeatGrant Branch::grant(SeatGrant quota, const Student& s) {
+    Category c = s.get_category_code();
+    switch (quota) {
+    case SeatGrant::Reserved:
+        --*reserved_by_category[(int)c];
+        reserved_cutoff[(int)c] = s.jee_rank;
+        reserved_seat_metric.inc();
+        seats_remaining_metric.add(-1);
+        run_log() << "Allocated " << name << " seat to " << s.get_name()
+             << " under " << s.get_category() << " category" << endl;
+        break;
+    case SeatGrant::General:
+        --general_seats;
+        general_cutoff = s.jee_rank;
+        general_seat_metric.inc();
+        seats_remaining_metric.add(-1);
+        run_log() << "Allocated " << name << " seat to " << s.get_name()
+             << " under General category" << endl;
+        break;
+    case SeatGrant::Supernumerary:
+        supernumerary_seat_metric.inc();
+        run_log() << "Allocated " << name << " supernumerary seat to " << s.get_name()
+             << " (tied at cutoff rank " << s.jee_rank << ")" << endl;
+        break;
+    case SeatGrant::None:
+        break;
+    }
+    return quota;
+}
+
+// True when the student's rank equals the last rank seated in the open
+// quota or in their category's quota.
+bool Branch::at_cutoff(const Student& s) const {
+    int c = (int)s.get_category_code();
+    return s.jee_rank == general_cutoff || (reserved_by_category[c] && s.jee_rank == reserved_cutoff[c]);
+}
+
+const string& Branch::get_name() const { return name; }
+BranchId Branch::get_id() const { return id; }
+int Branch::get_opening_rank() const { return opening_rank; }
+int Branch::get_closing_rank() const { return closing_rank; }
+
+int Branch::seats_total() const {
+    int sum = general_seats;
+    for (const auto &p : reserved_seats) sum += p.second;
+    return sum;
+}
+
+int Branch::general_remaining() const { return general_seats; }
+
+int Branch::reserved_remaining(const string& category) const {
+    auto it = reserved_seats.find(category);
+    return it != reserved_seats.end() ? it->second : 0;
+}
+
+int Branch::reserved_remaining(Category c) const {
+    const int* seats = reserved_by_category[(int)c];
+    return seats ? *seats : 0;
+}
+
+const unordered_map<string,int>& Branch::get_reserved_map() const { return reserved_seats; }
+
+BranchView Branch::view() const {
+    return BranchView{name, general_seats, reserved_seats, opening_rank, closing_rank};
+}
+
+void Branch::print_seat_status() const {
+    view().print_seat_status();
+}
+
+void BranchView::print_seat_status() const {
+    cout << "| " << setw(15) << left << name
+         << "| General: " << setw(3) << general_remaining;
+
+    for (const auto& cat : CATEGORIES) {
+        auto it = reserved_remaining.find(cat);
+        int rem = it != reserved_remaining.end() ? it->second : 0;
+        if (rem > 0) {
+            cout << "| " << cat << ": " << setw(3) << rem;
+        }
+    }
+    cout << "| Rank Range: " << opening_rank << "-" << closing_rank << " |" << endl;
+}
+
+Branch::~Branch() {
+    seats_remaining_metric.add(-seats_total());
+}
+
+void FreeBitset::assign(size_t n, bool value) {
+    bits = n;
+    levels.clear();
+    size_t count = n;
+    do {
+        size_t words = std::max<size_t>(1, (count + 63) / 64);
+        vector<uint64_t> level(words, value ? ~0ull : 0);
+        if (value && count % 64) level.back() = (1ull << (count % 64)) - 1;
+        if (count == 0) level.back() = 0;
+        levels.push_back(std::move(level));
+        count = words;
+    } while (count > 1);
+}
+
+void FreeBitset::set(size_t i) {
+    for (auto& level : levels) {
+        uint64_t& word = level[i >> 6];
+        bool was_empty = word == 0;
+        word |= 1ull << (i & 63);
+        if (!was_empty) break;
+        i >>= 6;
+    }
+}
+
+void FreeBitset::reset(size_t i) {
+    uint64_t& word = levels[0][i >> 6];
+    word &= ~(1ull << (i & 63));
+    if (word == 0) clear_summary(i >> 6);
+}
+
+// Word `word` of level 0 just became empty.
+void FreeBitset::clear_summary(size_t word) {
+    for (size_t k = 1; k < levels.size(); ++k) {
+        uint64_t& summary = levels[k][word >> 6];
+        summary &= ~(1ull << (word & 63));
+        if (summary != 0) break;
+        word >>= 6;
+    }
+}
+
+size_t FreeBitset::find_next(size_t from) const {
+    if (from >= bits) return bits;
+    size_t pos = from;
+    size_t k = 0;
+    for (;;) {
+        size_t w = pos >> 6;
+        if (w >= levels[k].size()) return bits;
+        uint64_t word = levels[k][w] & (~0ull << (pos & 63));
+        if (word) {
+            pos = (w << 6) | __builtin_ctzll(word);
+            break;
+        }
+        if (++k == levels.size()) return bits;
+        pos = w + 1;                // first word after w, as a bit one level up
+    }
+    while (k > 0) {
+        --k;
+        pos = (pos << 6) | __builtin_ctzll(levels[k][pos]);
+    }
+    return pos;
+}
+
+size_t FreeBitset::count(size_t from, size_t end) const {
+    size_t n = 0;
+    for (size_t i = from; i < end;) {
+        size_t w = i >> 6;
+        uint64_t word = levels[0][w] & (~0ull << (i & 63));
+        if (end < (w + 1) << 6) word &= (1ull << (end & 63)) - 1;
+        n += __builtin_popcountll(word);
+        i = (w + 1) << 6;
+    }
+    return n;
+}
+
+size_t FreeBitset::take(size_t from, size_t end, size_t n, vector<uint32_t>& out) {
+    size_t taken = 0;
+    end = std::min(end, bits);
+    for (size_t pos = find_next(from); taken < n && pos < end; pos = find_next(pos)) {
+        size_t w = pos >> 6;
+        uint64_t word = levels[0][w] & (~0ull << (pos & 63));
+        if (end < (w + 1) << 6) word &= (1ull << (end & 63)) - 1;
+        uint64_t grabbed = 0;
+        while (word && taken < n) {
+            uint64_t low = word & (~word + 1);
+            out.push_back((uint32_t)((w << 6) | __builtin_ctzll(word)));
+            grabbed |= low;
+            word ^= low;
+            ++taken;
+        }
+        levels[0][w] &= ~grabbed;
+        if (levels[0][w] == 0) clear_summary(w);
+        pos = (w + 1) << 6;
+        if (pos >= bits) break;
+    }
+    return taken;
+}
+
+static MetricCounter& rooms_allocated_metric =
+    metrics_registry().counter("admission_hostel_rooms_allocated_total", "Hostel beds allocated");
+static MetricCounter& rooms_released_metric =
+    metrics_registry().counter("admission_hostel_rooms_released_total", "Hostel beds given back");
+static MetricCounter& rooms_rejected_metric =
+    metrics_registry().counter("admission_hostel_requests_rejected_total", "Hostel room requests refused");
+static MetricGauge& rooms_free_metric =
+    metrics_registry().gauge("admission_hostel_rooms_free", "Unallocated hostel beds");
+
+Hostel::Hostel(string name_, int rooms) :
+    Hostel(std::move(name_), rooms > 0 ? vector<HostelBlockSpec>{{"Main", 1, rooms, 1}} : vector<HostelBlockSpec>())
+{
+}
+
+Hostel::Hostel(string name_, vector<HostelBlockSpec> blocks_) :
+    name(std::move(name_)),
+    blocks(std::move(blocks_)),
+    block_start(),
+    free_beds(),
+    beds_allocated(0),
+    first_bed(0)
+{
+    uint32_t beds = 0;
+    block_start.reserve(blocks.size() + 1);
+    for (HostelBlockSpec& b : blocks) {
+        b.floors = std::max(0, b.floors);
+        b.rooms_per_floor = std::max(0, b.rooms_per_floor);
+        b.beds_per_room = std::max(0, b.beds_per_room);
+        block_start.push_back(beds);
+        beds += (uint32_t)b.beds();
+    }
+    block_start.push_back(beds);
+    free_beds.assign(beds, true);
+    rooms_free_metric.add(beds);
+}
+
+Hostel::~Hostel() {
+    rooms_free_metric.add(-((long long)free_beds.size() - beds_allocated));
+}
+
+// The preferred block is searched first, then the whole hostel; both are
+// a find_next on the free-bed bitset.
+void Hostel::assign(Student& s, bool accepted, const char* label, int block) {
+    if (s.has_hostel()) return;
+    size_t none = free_beds.size();
+    size_t bed = none;
+    if (accepted && block >= 0 && block < (int)blocks.size()) {
+        bed = free_beds.find_next(block_start[block]);
+        if (bed >= block_start[block + 1]) bed = none;
+    }
+    if (accepted && bed == none) bed = free_beds.find_next(0);
+    if (bed == none) {
+        rooms_rejected_metric.inc();
+        return;
+    }
+    free_beds.reset(bed);
+    ++beds_allocated;
+    rooms_allocated_metric.inc();
+    rooms_free_metric.add(-1);
+    s.allocate_hostel(first_bed + (uint32_t)bed);
+    run_log() << "Allocated " << label << " room to " << s.get_name() << endl;
+}
+
+size_t Hostel::assign_all(ApplicantStore& store, const vector<ApplicantHandle>& intake,
+                          bool (*accepts)(const Student&), const char* label, int block) {
+    vector<ApplicantHandle> housed;
+    housed.reserve(intake.size());
+    size_t refused = 0;
+    for (ApplicantHandle h : intake) {
+        const Student& s = store[h];
+        if (s.has_hostel()) continue;
+        if (accepts(s)) housed.push_back(h);
+        else ++refused;
+    }
+
+    vector<uint32_t> beds;
+    beds.reserve(housed.size());
+    if (block >= 0 && block < (int)blocks.size()) {
+        free_beds.take(block_start[block], block_start[block + 1], housed.size(), beds);
+    }
+    free_beds.take(0, free_beds.size(), housed.size() - beds.size(), beds);
+    for (size_t i = 0; i < beds.size(); ++i) {
+        Student& s = store[housed[i]];
+        s.allocate_hostel(first_bed + beds[i]);
+        run_log() << "Allocated " << label << " room to " << s.get_name() << endl;
+    }
+
+    beds_allocated += (int)beds.size();
+    rooms_allocated_metric.inc((long long)beds.size());
+    rooms_free_metric.add(-(long long)beds.size());
+    rooms_rejected_metric.inc((long long)(refused + housed.size() - beds.size()));
+    return beds.size();
+}
+
+bool Hostel::release(Student& s) {
+    if (!s.has_hostel() || !holds(s.get_hostel_bed())) return false;
+    uint32_t bed = s.get_hostel_bed() - first_bed;
+    if (free_beds.test(bed)) return false;
+    free_beds.set(bed);
+    --beds_allocated;
+    rooms_released_metric.inc();
+    rooms_free_metric.add(1);
+    s.release_hostel();
+    run_log() << "Released " << name << " room of " << s.get_name() << endl;
+    return true;
+}
+
+bool Hostel::is_available() const {
+    return free_beds.find_next(0) < free_beds.size();
+}
+
+int Hostel::find_block(const string& block) const {
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        if (blocks[b].name == block) return (int)b;
+    }
+    return -1;
+}
+
+// "North / floor 2 / room 14 / bed 1"; the block, floor and bed are left
+// out when there is only one of them.
+string Hostel::describe_bed(uint32_t bed) const {
+    if (!holds(bed)) return "";
+    bed -= first_bed;
+    size_t b = upper_bound(block_start.begin(), block_start.end(), bed) - block_start.begin() - 1;
+    const HostelBlockSpec& spec = blocks[b];
+    uint32_t i = bed - block_start[b];
+    uint32_t slot = i % spec.beds_per_room;
+    i /= spec.beds_per_room;
+    uint32_t room = i % spec.rooms_per_floor;
+    uint32_t floor = i / spec.rooms_per_floor;
+
+    string out;
+    if (blocks.size() > 1) out += spec.name + " / ";
+    if (spec.floors > 1) out += "floor " + to_string(floor + 1) + " / ";
+    out += "room " + to_string(room + 1);
+    if (spec.beds_per_room > 1) out += " / bed " + to_string(slot + 1);
+    return out;
+}
+
+const string& Hostel::get_name() const { return name; }
+
+const vector<HostelBlockSpec>& Hostel::get_blocks() const { return blocks; }
+
+HostelView Hostel::view() const {
+    HostelView v{name, (int)free_beds.size(), beds_allocated, {}};
+    v.blocks.reserve(blocks.size());
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        v.blocks.push_back({blocks[b].name, blocks[b].beds(),
+                            (int)free_beds.count(block_start[b], block_start[b + 1])});
+    }
+    return v;
+}
+
+void Hostel::print_status() const {
+    view().print_status();
+}
+
+void HostelView::print_status() const {
+    cout << "| " << setw(15) << left << name
+         << "| Total: " << setw(4) << total_beds
+         << "| Allocated: " << setw(4) << beds_allocated
+         << "| Available: " << setw(4) << (total_beds - beds_allocated) << "|" << endl;
+    if (blocks.size() < 2) return;
+    for (const Block& b : blocks) {
+        cout << "|   " << setw(13) << left << b.name
+             << "| Beds: " << setw(5) << b.beds
+             << "| Free: " << setw(5) << b.free << "|" << endl;
+    }
+}
+
+
+uint32_t Hostel::room_start(uint32_t bed) const {
+    uint32_t local = bed - first_bed;
+    size_t b = upper_bound(block_start.begin(), block_start.end(), local) - block_start.begin() - 1;
+    return bed - (local - block_start[b]) % blocks[b].beds_per_room;
+}
+
+bool RoommateProfile::parse_csv(const string& line) {
+    vector<int> values;
+    istringstream in(line);
+    string field;
+    while (getline(in, field, ',')) {
+        char* end = nullptr;
+        long v = strtol(field.c_str(), &end, 10);
+        if (field.empty() || (*end && *end != '\r')) return false;
+        values.push_back((int)v);
+    }
+    if (values.size() != TRAITS + 1 && values.size() != TRAITS + 2) return false;
+    roll = values[0];
+    for (int t = 0; t < TRAITS; ++t) {
+        if (values[t + 1] < 0 || values[t + 1] > 10) return false;
+        traits[t] = (uint8_t)values[t + 1];
+    }
+    requested_roll = values.size() == TRAITS + 2 ? values[TRAITS + 1] : 0;
+    return true;
+}
+
+RoommateMatcher::RoommateMatcher(uint64_t seed_, int passes_) :
+    seed(seed_),
+    passes(std::max(0, passes_))
+{ }
+
+int RoommateMatcher::distance(const Person& a, const Person& b) {
+    int d = 0;
+    for (int t = 0; t < RoommateProfile::TRAITS; ++t) d += abs((int)a.traits[t] - (int)b.traits[t]);
+    return d;
+}
+
+vector<uint32_t> RoommateMatcher::match(const vector<Person>& people, const vector<int>& rooms, Report& report) const {
+    auto start = chrono::steady_clock::now();
+    const size_t n = people.size();
+    report = Report{n, 0, 0, 0, 0.0, 0.0, 0, 0.0};
+
+    vector<uint32_t> room_offset(rooms.size() + 1, 0);
+    for (size_t r = 0; r < rooms.size(); ++r) {
+        room_offset[r + 1] = room_offset[r] + (uint32_t)std::max(0, rooms[r]);
+        if (rooms[r] >= 2) ++report.shared_rooms;
+    }
+    vector<uint32_t> order(n);
+    iota(order.begin(), order.end(), 0u);
+    if (room_offset.back() != n) return order;
+
+    // Distance from `who` to everyone in room r except position `skip`.
+    auto distance_in = [&](size_t r, uint32_t skip, uint32_t who) {
+        int d = 0;
+        for (uint32_t k = room_offset[r]; k < room_offset[r + 1]; ++k) {
+            if (k != skip) d += distance(people[who], people[order[k]]);
+        }
+        return d;
+    };
+    auto mean_distance = [&]() {
+        long long total = 0, pairs = 0;
+        for (size_t r = 0; r < rooms.size(); ++r) {
+            for (uint32_t a = room_offset[r]; a < room_offset[r + 1]; ++a) {
+                for (uint32_t b = a + 1; b < room_offset[r + 1]; ++b) {
+                    total += distance(people[order[a]], people[order[b]]);
+                    ++pairs;
+                }
+            }
+        }
+        return pairs ? (double)total / pairs : 0.0;
+    };
+    report.distance_before = mean_distance();
+
+    // Bucket every mutual pair or single by HASHES quantised projections
+    // of its traits, then order buckets by one more projection.
+    const int HASHES = 3, WIDTH = 12;
+    mt19937_64 rng(seed);
+    uniform_int_distribution<int> coefficient(-4, 4), shift(0, WIDTH - 1);
+    array<array<int, RoommateProfile::TRAITS>, HASHES + 1> planes;
+    array<int, HASHES + 1> offsets;
+    for (int h = 0; h <= HASHES; ++h) {
+        for (int& c : planes[h]) c = coefficient(rng);
+        offsets[h] = shift(rng);
+    }
+    auto project = [&](const array<uint8_t, RoommateProfile::TRAITS>& traits, int h) {
+        int v = offsets[h];
+        for (int t = 0; t < RoommateProfile::TRAITS; ++t) v += planes[h][t] * traits[t];
+        return v;
+    };
+
+    struct Unit {
+        uint32_t first;
+        uint32_t second;            // NO_PARTNER for a single
+        uint64_t bucket;
+        int projection;
+    };
+    vector<Unit> units;
+    units.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t p = people[i].partner;
+        bool mutual = p < n && p != i && people[p].partner == i;
+        if (mutual && p < i) continue;
+        array<uint8_t, RoommateProfile::TRAITS> traits = people[i].traits;
+        if (mutual) {
+            ++report.mutual_requests;
+            for (int t = 0; t < RoommateProfile::TRAITS; ++t) traits[t] = (uint8_t)((traits[t] + people[p].traits[t] + 1) / 2);
+        }
+        uint64_t bucket = 0;
+        for (int h = 0; h < HASHES; ++h) {
+            int v = project(traits, h);
+            int q = v >= 0 ? v / WIDTH : -((-v + WIDTH - 1) / WIDTH);
+            bucket = (bucket << 10) | (uint64_t)((q + 512) & 1023);
+        }
+        units.push_back(Unit{i, mutual ? p : NO_PARTNER, bucket, project(traits, HASHES)});
+    }
+    sort(units.begin(), units.end(), [](const Unit& a, const Unit& b) {
+        if (a.bucket != b.bucket) return a.bucket < b.bucket;
+        if (a.projection != b.projection) return a.projection < b.projection;
+        return a.first < b.first;
+    });
+
+    // Deal units into rooms in bucket order. A pair waits for a room with
+    // two free beds; pairs still waiting at the end are split.
+    vector<char> locked(n, 0);      // kept with the requested roommate
+    deque<size_t> waiting;
+    vector<uint32_t> split;
+    size_t next = 0, pos = 0;
+    for (size_t r = 0; r < rooms.size(); ++r) {
+        int free = rooms[r];
+        while (free > 0) {
+            if (free >= 2 && !waiting.empty()) {
+                const Unit& u = units[waiting.front()];
+                waiting.pop_front();
+                order[pos++] = u.first;
+                order[pos++] = u.second;
+                locked[u.first] = locked[u.second] = 1;
+                free -= 2;
+            } else if (next < units.size()) {
+                const Unit& u = units[next++];
+                if (u.second == NO_PARTNER) {
+                    order[pos++] = u.first;
+                    --free;
+                } else if (free >= 2) {
+                    order[pos++] = u.first;
+                    order[pos++] = u.second;
+                    locked[u.first] = locked[u.second] = 1;
+                    free -= 2;
+                } else {
+                    waiting.push_back(next - 1);
+                }
+            } else if (!split.empty()) {
+                order[pos++] = split.back();
+                split.pop_back();
+                --free;
+            } else {
+                const Unit& u = units[waiting.front()];
+                waiting.pop_front();
+                order[pos++] = u.first;
+                split.push_back(u.second);
+                --free;
+            }
+        }
+    }
+    report.requests_kept = (size_t)count(locked.begin(), locked.end(), 1) / 2;
+
+    // Swap occupants between each room and its neighbour in bucket order,
+    // plus one random room, while that lowers the in-room distance.
+    uniform_int_distribution<size_t> any_room(0, rooms.empty() ? 0 : rooms.size() - 1);
+    for (int pass = 0; pass < passes; ++pass) {
+        size_t swaps_before = report.swaps;
+        for (size_t r = 0; r < rooms.size(); ++r) {
+            size_t others[2] = {r + 1, any_room(rng)};
+            for (size_t s : others) {
+                if (s >= rooms.size() || s == r || (rooms[r] < 2 && rooms[s] < 2)) continue;
+                for (uint32_t a = room_offset[r]; a < room_offset[r + 1]; ++a) {
+                    if (locked[order[a]]) continue;
+                    for (uint32_t b = room_offset[s]; b < room_offset[s + 1]; ++b) {
+                        if (locked[order[b]]) continue;
+                        int delta = distance_in(r, a, order[b]) - distance_in(r, a, order[a]) +
+                                    distance_in(s, b, order[a]) - distance_in(s, b, order[b]);
+                        if (delta < 0) {
+                            swap(order[a], order[b]);
+                            ++report.swaps;
+                        }
+                    }
+                }
+            }
+        }
+        if (report.swaps == swaps_before) break;
+    }
+
+    report.distance_after = mean_distance();
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return order;
+}
+
+void RoommateMatcher::Report::print(const string& hostel) const {
+    ostringstream line;
+    line << fixed << setprecision(2) << hostel << ": " << students << " students, " << shared_rooms
+         << " shared rooms | mean roommate distance " << distance_before << " -> " << distance_after
+         << " | requests kept " << requests_kept << "/" << mutual_requests << " | " << swaps
+         << " swaps in " << setprecision(3) << seconds << "s";
+    cout << line.str() << endl;
+}
+
+
+MetricCounter University::total_admitted_global;
+
+University::University(string name_, int opening_rank_, int closing_rank_) :
+    name(std::move(name_)),
+    total_seats(0),
+    branches(),
+    admitted_students(),
+    roster_generation(0),
+    opening_rank(std::max(1, opening_rank_)),
+    closing_rank(std::max(1, closing_rank_)),
+    policy(0)
+{
+    if (closing_rank < opening_rank) {
+        closing_rank = opening_rank;
+    }
+    register_university(name);
+}
+
+void University::add_branch(unique_ptr<Branch> b) {
+    if (!b) return;
+    MemoryScope mem(MEM_SEAT_STATE);
+    total_seats += b->seats_total();
+    Branch* raw = b.get();
+    if (branches.emplace(b->get_name(), std::move(b)).second) {
+        branches_by_id[raw->get_id()] = raw;
+    }
+}
+
+bool University::can_admit(const Student& s) const {
+    if (s.jee_rank < opening_rank || s.jee_rank > closing_rank) return false;
+    return total_seats > 0 || shares_ties();
+}
+
+Branch* University::find_branch(BranchId id) const {
+    auto it = branches_by_id.find(id);
+    return it != branches_by_id.end() ? it->second : nullptr;
+}
+
+// Tries one branch of this university; the caller walks the preferences.
+// The switch picks the allocation path compiled for this university's
+// policy.
+bool University::admit_student(ApplicantStore& store, ApplicantHandle h, Branch* br) {
+    Student& s = store[h];
+    if (!br) return false;
+    if (s.is_admitted()) return false;
+    if (!s.is_eligible()) return false;
+    if (!can_admit(s)) return false;
+
+    SeatGrant granted;
+    switch (policy) {
+    case 0: granted = br->allocate_seat<ReservedFirst, StrictCutoff>(s); break;
+    case 1: granted = br->allocate_seat<MeritFirst, StrictCutoff>(s); break;
+    case 2: granted = br->allocate_seat<ReservedFirst, ShareCutoff>(s); break;
+    default: granted = br->allocate_seat<MeritFirst, ShareCutoff>(s); break;
+    }
+    if (granted == SeatGrant::None) return false;
+
+    MemoryScope mem(MEM_SEAT_STATE);
+    if (!holds_roster_of(store)) {
+        admitted_students.clear();      // handles of a store since cleared
+        roster_generation = store.get_generation();
+    }
+    admitted_students.push_back(h);
+    s.set_admitted(br->get_id());
+    if (granted != SeatGrant::Supernumerary) total_seats -= 1;
+    total_admitted_global.inc();
+    return true;
+}
+
+// Admitted rows are resolved through `store`; without one (no run seen
+// yet), or with a store cleared since the roster was built, the view
+// carries seat state only. Handles the store no longer backs with an
+// admitted student are left out.
+UniversityView University::view(const ApplicantStore* store) const {
+    UniversityView v{name, opening_rank, closing_rank, {}, {}};
+    v.branches.reserve(branches.size());
+    for (const auto& branch : branches) {
+        if (branch.second) v.branches.push_back(branch.second->view());
+    }
+    if (!store || !holds_roster_of(*store)) return v;
+    v.admitted.reserve(admitted_students.size());
+    for (ApplicantHandle h : admitted_students) {
+        if (!store->contains(h)) continue;
+        const Student& s = (*store)[h];
+        if (!s.is_admitted()) continue;
+        v.admitted.push_back({s.get_roll(), string(s.get_name()), s.jee_rank, s.get_assigned_branch()});
+    }
+    return v;
+}
+
+void University::print_admitted(const ApplicantStore& store) const {
+    view(&store).print_admitted();
+}
+
+void University::print_branch_status() const {
+    view(nullptr).print_branch_status();
+}
+
+void UniversityView::print_admitted() const {
+    cout << "+-------------------------------------------------------------+" << endl;
+    cout << "| " << setw(58) << left << ("University: " + name) << "|" << endl;
+    cout << "| Admitted Students: " << setw(38) << left << admitted.size() << "|" << endl;
+    cout << "| Rank Range: " << setw(44) << left << (to_string(opening_rank) + " - " + to_string(closing_rank)) << "|" << endl;
+    cout << "+-------------------------------------------------------------+" << endl;
+
+    if (admitted.empty()) {
+        cout << "| No students admitted                                              |" << endl;
+    } else {
+        for (const auto& a : admitted) {
+            cout << "| > Roll " << setw(4) << a.roll
+                 << " | " << setw(20) << left << a.name.substr(0, 19)
+                 << " | Rank: " << setw(6) << a.jee_rank
+                 << " | Branch: " << setw(12) << left << a.branch << "|" << endl;
+        }
+    }
+    cout << "+-------------------------------------------------------------+" << endl;
+}
+
+void UniversityView::print_branch_status() const {
+    cout << "+-------------------------------------------------------------+" << endl;
+    cout << "| " << setw(58) << left << ("Branch Status - " + name) << "|" << endl;
+    cout << "+-------------------------------------------------------------+" << endl;
+    for (const auto& branch : branches) {
+        branch.print_seat_status();
+    }
+    cout << "+-------------------------------------------------------------+" << endl;
+}
+
+const unordered_map<string, unique_ptr<Branch>>& University::get_branches() const { return branches; }
+const string& University::get_name() const { return name; }
+int University::get_opening_rank() const { return opening_rank; }
+int University::get_closing_rank() const { return closing_rank; }
+int University::get_admitted_count() const { return admitted_students.size(); }
+const vector<ApplicantHandle>& University::get_admitted() const { return admitted_students; }
+long long University::total_admitted() { return total_admitted_global.value(); }
+
+University::~University() = default;
+
+StudentTable::StudentTable() :
+    generation(0),
+    chunks(),
+    order(make_shared<const vector<ApplicantHandle>>()),
+    by_roll(make_shared<const vector<ApplicantHandle>>())
+{ }
+
+const StudentView* StudentTable::find(int roll) const {
+    auto it = lower_bound(by_roll->begin(), by_roll->end(), roll,
+                          [this](ApplicantHandle h, int r) { return row(h).roll < r; });
+    if (it == by_roll->end() || row(*it).roll != roll) return nullptr;
+    return &row(*it);
+}
+
+AdmissionSnapshot::AdmissionSnapshot() :
+    epoch(0),
+    universities(),
+    hostels(),
+    messes(),
+    students(make_shared<const StudentTable>())
+{ }
+
+const StudentView* AdmissionSnapshot::find_student(int roll) const {
+    return students->find(roll);
+}
+
+void AdmissionSnapshot::print_all_admissions() const {
+    printHeader("ADMISSIONS SUMMARY");
+
+    for (const auto& u : universities) {
+        u.print_admitted();
+    }
+
+    cout << "\nTOTAL STUDENTS ADMITTED: " << stats.admitted << endl;
+    stats.print_summary();
+}
+
+void AdmissionSnapshot::print_detailed_report() const {
+    printHeader("DETAILED ADMISSION REPORT");
+
+    for (const auto& u : universities) {
+        u.print_branch_status();
+    }
+
+    printSection("HOSTEL STATUS");
+    for (const auto& h : hostels) h.print_status();
+
+    if (!messes.empty()) {
+        printSection("MESS STATUS");
+        for (const auto& m : messes) m.print_status();
+    }
+}
+
+static void copy_name(char* dst, const string& src) {
+    size_t n = std::min(src.size(), (size_t)SeatTableData::NAME_LEN - 1);
+    memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+size_t SeatTableSegment::bytes_for(uint32_t universities, uint32_t branches) {
+    return sizeof(SeatTableSegment) + (size_t)universities * sizeof(SeatTableData::UniversityRow) +
+           (size_t)branches * sizeof(SeatTableData::BranchRow);
+}
+
+// Sized for `universities` and `branches` rows. A segment left behind
+// by an earlier writer is taken over but never shrunk, since its readers
+// may still map all of it.
+SeatTablePublisher::SeatTablePublisher(string name_, uint32_t universities, uint32_t branches) :
+    name(std::move(name_)),
+    fd(-1),
+    segment(nullptr),
+    mapped(0)
+{
+    fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return;
+    struct stat st;
+    size_t bytes = SeatTableSegment::bytes_for(universities, branches);
+    if (fstat(fd, &st) == 0) bytes = std::max(bytes, (size_t)st.st_size);
+    if (ftruncate(fd, bytes) == 0) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            segment = static_cast<SeatTableSegment*>(p);
+            mapped = bytes;
+        }
+    }
+    if (!segment) {
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    // Readers check magic/version before trusting anything else.
+    segment->magic = 0;
+    segment->sequence.store(0, memory_order_relaxed);
+    segment->university_capacity = universities;
+    segment->branch_capacity = branches;
+    memset(&segment->summary, 0, bytes - offsetof(SeatTableSegment, summary));
+    segment->layout_version = SeatTableSegment::LAYOUT_VERSION;
+    atomic_thread_fence(memory_order_release);
+    segment->magic = SeatTableSegment::MAGIC;
+}
+
+bool SeatTablePublisher::is_open() const { return segment != nullptr; }
+
+// Grows the segment to hold at least this many rows. Called while the
+// sequence is odd; every row is rewritten afterwards.
+bool SeatTablePublisher::reserve(uint32_t universities, uint32_t branches) {
+    if (universities <= segment->university_capacity && branches <= segment->branch_capacity) return true;
+    universities = std::max(universities, segment->university_capacity);
+    branches = std::max(branches, segment->branch_capacity);
+    size_t bytes = SeatTableSegment::bytes_for(universities, branches);
+    if (bytes > mapped) {
+        if (ftruncate(fd, bytes) != 0) return false;
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        munmap(segment, mapped);
+        segment = static_cast<SeatTableSegment*>(p);
+        mapped = bytes;
+    }
+    segment->university_capacity = universities;
+    segment->branch_capacity = branches;
+    return true;
+}
+
+void SeatTablePublisher::publish(const AdmissionSnapshot& snap) {
+    if (!segment) return;
+    uint32_t total_universities = (uint32_t)snap.universities.size(), total_branches = 0;
+    for (const auto& u : snap.universities) total_branches += (uint32_t)u.branches.size();
+
+    uint64_t seq = segment->sequence.load(memory_order_relaxed);
+    segment->sequence.store(seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    reserve(total_universities, total_branches);    // on failure, the rows that fit
+    SeatTableSummary& d = segment->summary;
+    SeatTableData::UniversityRow* university_rows = segment->university_rows();
+    SeatTableData::BranchRow* branch_rows = segment->branch_rows();
+    d.epoch = snap.epoch;
+    d.applicants = (int64_t)snap.students->size();
+    d.eligible = (int64_t)snap.stats.eligible;
+    d.admitted = (int64_t)snap.stats.admitted;
+    d.hostel_allocated = (int64_t)snap.stats.hostel_allocated;
+    d.mess_allocated = (int64_t)snap.stats.mess_allocated;
+    uint32_t nu = 0, nb = 0;
+    for (const auto& u : snap.universities) {
+        if (nu == segment->university_capacity) break;
+        SeatTableData::UniversityRow& ur = university_rows[nu++];
+        copy_name(ur.name, u.name);
+        ur.opening_rank = u.opening_rank;
+        ur.closing_rank = u.closing_rank;
+        ur.admitted = (int32_t)u.admitted.size();
+        ur.first_branch = nb;
+        for (const auto& b : u.branches) {
+            if (nb == segment->branch_capacity) break;
+            SeatTableData::BranchRow& br = branch_rows[nb++];
+            copy_name(br.name, b.name);
+            br.general_remaining = b.general_remaining;
+            for (int c = 0; c < SeatTableData::CATEGORY_COUNT; ++c) {
+                auto it = b.reserved_remaining.find(CATEGORIES[c]);
+                br.reserved_remaining[c] = it != b.reserved_remaining.end() ? it->second : 0;
+            }
+            br.opening_rank = b.opening_rank;
+            br.closing_rank = b.closing_rank;
+        }
+        ur.branch_count = nb - ur.first_branch;
+    }
+    d.university_count = nu;
+    d.branch_count = nb;
+    d.total_universities = total_universities;
+    d.total_branches = total_branches;
+    d.truncated = nu < total_universities || nb < total_branches;
+
+    atomic_thread_fence(memory_order_release);
+    segment->sequence.store(seq + 2, memory_order_release);
+}
+
+// The segment is unlinked so a stale table never outlives its writer;
+// readers that still have it mapped keep the last published copy.
+SeatTablePublisher::~SeatTablePublisher() {
+    if (!segment) return;
+    munmap(segment, mapped);
+    close(fd);
+    shm_unlink(name.c_str());
+}
+
+SeatTableReader::SeatTableReader(const string& name) :
+    fd(-1),
+    segment(nullptr),
+    mapped(0)
+{
+    fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return;
+    if (!remap() || segment->magic != SeatTableSegment::MAGIC ||
+        segment->layout_version != SeatTableSegment::LAYOUT_VERSION) {
+        if (segment) munmap(const_cast<SeatTableSegment*>(segment), mapped);
+        segment = nullptr;
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool SeatTableReader::is_open() const { return segment != nullptr; }
+
+// Maps the whole segment as it is now; the writer only ever grows it.
+bool SeatTableReader::remap() {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SeatTableSegment)) return false;
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+    if (segment) munmap(const_cast<SeatTableSegment*>(segment), mapped);
+    segment = static_cast<const SeatTableSegment*>(p);
+    mapped = (size_t)st.st_size;
+    return true;
+}
+
+// Gives up after a bounded number of torn reads rather than spinning
+// behind a writer that is mid-update for a long time.
+bool SeatTableReader::read(SeatTableData& out) {
+    if (!segment) return false;
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        uint64_t before = segment->sequence.load(memory_order_acquire);
+        if (before & 1) {
+            this_thread::yield();
+            continue;
+        }
+        uint32_t university_capacity = segment->university_capacity;
+        uint32_t branch_capacity = segment->branch_capacity;
+        if (SeatTableSegment::bytes_for(university_capacity, branch_capacity) > mapped) {
+            if (!remap()) return false;
+            continue;
+        }
+        SeatTableSummary summary;
+        memcpy(&summary, &segment->summary, sizeof(summary));
+        uint32_t nu = std::min(summary.university_count, university_capacity);
+        uint32_t nb = std::min(summary.branch_count, branch_capacity);
+        auto university_rows = reinterpret_cast<const SeatTableData::UniversityRow*>(segment + 1);
+        auto branch_rows = reinterpret_cast<const SeatTableData::BranchRow*>(university_rows + university_capacity);
+        out.universities.assign(university_rows, university_rows + nu);
+        out.branches.assign(branch_rows, branch_rows + nb);
+        atomic_thread_fence(memory_order_acquire);
+        if (segment->sequence.load(memory_order_relaxed) == before) {
+            static_cast<SeatTableSummary&>(out) = summary;
+            out.university_count = nu;
+            out.branch_count = nb;
+            return true;
+        }
+    }
+    return false;
+}
+
+SeatTableReader::~SeatTableReader() {
+    if (!segment) return;
+    munmap(const_cast<SeatTableSegment*>(segment), mapped);
+    close(fd);
+}
+
+namespace {
+
+const char* const DEFAULT_CAMPUS_CONFIG = R"(# Sample campus used by the frontends and tools.
+hostel boys "Boys Hostel A" 40
+hostel girls "Girls Hostel B" 40
+mess "Main Campus Mess" 60 Basic=2000 Standard=3000 Premium=4500
+
+university "TechVille Institute of Technology" 1 50000
+branch "Computer Science" 15 1 5000 OBC=5 SC=3 ST=2 EWS=2
+branch "Electronics" 12 1 8000 OBC=4 SC=2 EWS=2
+branch "Mechanical" 10 1 15000 OBC=3 SC=2 ST=1
+
+university "Global Engineering College" 1 75000
+branch "Computer Science" 12 1 3000 OBC=4 SC=2 EWS=2
+branch "Information Technology" 10 1 7000 OBC=3 SC=2 EWS=1
+branch "Civil Engineering" 8 1 20000 OBC=2 SC=2 ST=1
+)";
+
+// Splits a config line into words; "quoted text" is one word and '#'
+// outside quotes ends the line. False on an unterminated quote.
+bool split_config_line(const string& line, vector<string>& words) {
+    words.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        if (isspace((unsigned char)line[i])) { ++i; continue; }
+        if (line[i] == '#') break;
+        string word;
+        if (line[i] == '"') {
+            size_t close = line.find('"', i + 1);
+            if (close == string::npos) return false;
+            word = line.substr(i + 1, close - i - 1);
+            i = close + 1;
+        } else {
+            while (i < line.size() && !isspace((unsigned char)line[i])) word += line[i++];
+        }
+        words.push_back(std::move(word));
+    }
+    return true;
+}
+
+bool parse_config_int(const string& word, int& out) {
+    if (word.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    long v = strtol(word.c_str(), &end, 10);
+    if (*end || errno || v < INT_MIN || v > INT_MAX) return false;
+    out = (int)v;
+    return true;
+}
+
+bool valid_window(int opening, int closing) { return opening >= 1 && opening <= closing; }
+
+// "SC,ST" -> a bit per Category. On failure bad is the unknown name.
+bool parse_category_set(const string& list, uint8_t& out, string& bad) {
+    istringstream names(list);
+    string c;
+    while (getline(names, c, ',')) {
+        auto cat = find(CATEGORIES.begin(), CATEGORIES.end(), c);
+        if (cat == CATEGORIES.end()) {
+            bad = c;
+            return false;
+        }
+        out |= (uint8_t)(1u << (cat - CATEGORIES.begin()));
+    }
+    return true;
+}
+
+// "MIN-MAX" in rupees; either end may be left open.
+bool parse_income_band(const string& band, int& lo, int& hi) {
+    size_t dash = band.find('-');
+    if (dash == string::npos) return false;
+    string from = band.substr(0, dash), to = band.substr(dash + 1);
+    return (from.empty() || parse_config_int(from, lo)) && (to.empty() || parse_config_int(to, hi)) && lo <= hi;
+}
+
+const int MAX_HOSTEL_BEDS = 1 << 24;
+
+// Binary image written by CampusConfig::write_cache:
+//   header, messes[], universities[], branches[], hostels[], blocks[],
+//   plan rules[], string bytes.
+// Plain host-order records; it is a cache of a local file, never shipped.
+struct CampusCacheHeader {
+    static const uint32_t MAGIC = 0x504d4143;  // "CAMP"
+    static const uint32_t VERSION = 4;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint32_t university_count;
+    uint32_t branch_count;
+    uint32_t hostel_count;
+    uint32_t block_count;
+    uint32_t mess_count;
+    uint32_t rule_count;
+    uint32_t string_bytes;
+};
+
+struct CachedName {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct CachedMess {
+    CachedName name;
+    int32_t capacity;
+    int32_t prices[3];
+};
+
+struct CachedUniversity {
+    CachedName name;
+    int32_t opening_rank;
+    int32_t closing_rank;
+    uint32_t policy;                // bit 0 merit-first, bit 1 share-ties
+    uint32_t branch_count;
+};
+
+struct CachedBranch {
+    CachedName name;
+    int32_t general_seats;
+    int32_t reserved[CATEGORY_COUNT];
+    int32_t opening_rank;
+    int32_t closing_rank;
+};
+
+struct CachedHostel {
+    CachedName name;
+    uint32_t residents;
+    int32_t priority;
+    uint32_t block_count;
+};
+
+struct CachedBlock {
+    CachedName name;
+    int32_t floors;
+    int32_t rooms_per_floor;
+    int32_t beds_per_room;
+};
+
+struct CachedPlanRule {
+    uint32_t categories;
+    int32_t min_income;
+    int32_t max_income;
+    uint32_t residence;
+    int32_t plan;
+};
+
+unique_ptr<University> make_university(const CampusConfig::UniversitySpec& spec) {
+    auto uni = make_unique<University>(spec.name, spec.opening_rank, spec.closing_rank);
+    if (spec.merit_first && spec.share_ties) uni->use_policy<MeritFirst, ShareCutoff>();
+    else if (spec.merit_first) uni->use_policy<MeritFirst, StrictCutoff>();
+    else if (spec.share_ties) uni->use_policy<ReservedFirst, ShareCutoff>();
+    for (const auto& b : spec.branches) {
+        unordered_map<string,int> reserved;
+        for (int c = 0; c < CATEGORY_COUNT; ++c) {
+            if (b.reserved[c] > 0) reserved[CATEGORIES[c]] = b.reserved[c];
+        }
+        uni->add_branch(make_unique<Branch>(b.name, b.general_seats, std::move(reserved),
+                                            b.opening_rank, b.closing_rank));
+    }
+    return uni;
+}
+
+}
+
+size_t CampusConfig::branch_count() const {
+    size_t n = 0;
+    for (const auto& u : universities) n += u.branches.size();
+    return n;
+}
+
+// Replaces nothing on failure; error is "line N: reason".
+bool CampusConfig::parse(istream& in, string& error) {
+    CampusConfig out;
+    unordered_set<string> university_names;
+    unordered_set<string> branch_names;
+    HostelSpec* hostel = nullptr;       // the one block lines add to
+    vector<string> w;
+    string line;
+    int line_no = 0;
+    auto fail = [&](const string& why) {
+        error = "line " + to_string(line_no) + ": " + why;
+        return false;
+    };
+    while (getline(in, line)) {
+        ++line_no;
+        if (!split_config_line(line, w)) return fail("unterminated quote");
+        if (w.empty()) continue;
+        const string& kind = w[0];
+
+        if (kind == "university") {
+            UniversitySpec u{"", 1, INT_MAX, false, false, {}};
+            if (w.size() < 4 || w[1].empty()) return fail("expected: university \"name\" opening closing [merit-first] [share-ties]");
+            u.name = w[1];
+            if (!parse_config_int(w[2], u.opening_rank) || !parse_config_int(w[3], u.closing_rank) ||
+                !valid_window(u.opening_rank, u.closing_rank)) return fail("bad rank window for " + u.name);
+            for (size_t i = 4; i < w.size(); ++i) {
+                if (w[i] == "merit-first") u.merit_first = true;
+                else if (w[i] == "share-ties") u.share_ties = true;
+                else return fail("unknown university option '" + w[i] + "'");
+            }
+            if (!university_names.insert(u.name).second) return fail("duplicate university " + u.name);
+            branch_names.clear();
+            out.universities.push_back(std::move(u));
+        } else if (kind == "branch") {
+            if (out.universities.empty()) return fail("branch before any university");
+            BranchSpec b{"", 0, {}, 1, INT_MAX};
+            if (w.size() < 5 || w[1].empty()) return fail("expected: branch \"name\" seats opening closing [CATEGORY=seats ...]");
+            b.name = w[1];
+            if (b.name.find('/') != string::npos) return fail("branch names cannot contain '/'");
+            if (!parse_config_int(w[2], b.general_seats) || b.general_seats < 0) return fail("bad seat count for " + b.name);
+            if (!parse_config_int(w[3], b.opening_rank) || !parse_config_int(w[4], b.closing_rank) ||
+                !valid_window(b.opening_rank, b.closing_rank)) return fail("bad rank window for " + b.name);
+            for (size_t i = 5; i < w.size(); ++i) {
+                size_t eq = w[i].find('=');
+                auto cat = eq == string::npos ? CATEGORIES.end() : find(CATEGORIES.begin(), CATEGORIES.end(), w[i].substr(0, eq));
+                int seats;
+                if (cat == CATEGORIES.end()) return fail("expected CATEGORY=seats, got '" + w[i] + "'");
+                if (!parse_config_int(w[i].substr(eq + 1), seats) || seats < 0) return fail("bad reserved seats in '" + w[i] + "'");
+                b.reserved[cat - CATEGORIES.begin()] = seats;
+            }
+            if (!branch_names.insert(b.name).second) return fail("duplicate branch " + b.name);
+            out.universities.back().branches.push_back(std::move(b));
+        } else if (kind == "hostel") {
+            static const array<string, 3> RESIDENTS = {"boys", "girls", "any"};
+            auto residents = w.size() < 3 ? RESIDENTS.end() : find(RESIDENTS.begin(), RESIDENTS.end(), w[1]);
+            if (residents == RESIDENTS.end() || w[2].empty())
+                return fail("expected: hostel boys|girls|any \"name\" [rooms] [priority=N]");
+            HostelSpec h{w[2], (Residents)(residents - RESIDENTS.begin()), 0, {}};
+            int rooms = 0;
+            for (size_t i = 3; i < w.size(); ++i) {
+                if (w[i].compare(0, 9, "priority=") == 0) {
+                    if (!parse_config_int(w[i].substr(9), h.priority)) return fail("bad priority for " + h.name);
+                } else if (i != 3 || !parse_config_int(w[i], rooms) || rooms < 0 || rooms > MAX_HOSTEL_BEDS) {
+                    return fail("bad room count for " + h.name);
+                }
+            }
+            for (const HostelSpec& other : out.hostels) {
+                if (other.name == h.name) return fail("duplicate hostel " + h.name);
+            }
+            if (rooms > 0) h.blocks.push_back({"Main", 1, rooms, 1});
+            out.hostels.push_back(std::move(h));
+            hostel = &out.hostels.back();
+        } else if (kind == "block") {
+            if (!hostel) return fail("block before any hostel");
+            HostelBlockSpec b{"", 0, 0, 0};
+            if (w.size() != 5 || w[1].empty()) return fail("expected: block \"name\" floors rooms-per-floor beds-per-room");
+            b.name = w[1];
+            if (!parse_config_int(w[2], b.floors) || !parse_config_int(w[3], b.rooms_per_floor) ||
+                !parse_config_int(w[4], b.beds_per_room) || b.floors < 1 || b.rooms_per_floor < 1 ||
+                b.beds_per_room < 1) return fail("bad layout for block " + b.name);
+            long long beds = (long long)b.floors * b.rooms_per_floor * b.beds_per_room;
+            for (const HostelBlockSpec& other : hostel->blocks) {
+                if (other.name == b.name) return fail("duplicate block " + b.name);
+                beds += other.beds();
+            }
+            if (beds > MAX_HOSTEL_BEDS) return fail(hostel->name + " has more than " + to_string(MAX_HOSTEL_BEDS) + " beds");
+            hostel->blocks.push_back(std::move(b));
+        } else if (kind == "mess") {
+            MessSpec m{"", 0, {2000, 3000, 4500}};
+            if (w.size() < 3 || w[1].empty()) return fail("expected: mess \"name\" capacity [Plan=price ...]");
+            m.name = w[1];
+            if (!parse_config_int(w[2], m.capacity) || m.capacity < 0) return fail("bad capacity for " + m.name);
+            for (size_t i = 3; i < w.size(); ++i) {
+                size_t eq = w[i].find('=');
+                MessPlan plan;
+                int price;
+                if (eq == string::npos || !parse_mess_plan(w[i].substr(0, eq), plan)) return fail("expected Plan=price, got '" + w[i] + "'");
+                if (!parse_config_int(w[i].substr(eq + 1), price) || price < 0) return fail("bad price in '" + w[i] + "'");
+                if (i == 3) m.prices.fill(-1);
+                m.prices[(int)plan] = price;
+            }
+            for (const MessSpec& other : out.messes) {
+                if (other.name == m.name) return fail("duplicate mess " + m.name);
+            }
+            if (out.messes.size() == (size_t)MAX_MESS_OUTLETS) return fail("more than " + to_string(MAX_MESS_OUTLETS) + " mess outlets");
+            out.messes.push_back(std::move(m));
+        } else if (kind == "plan") {
+            MessPlanRule r{0, 0, INT_MAX, MessResidence::Any, NO_MESS_PLAN};
+            MessPlan plan;
+            if (w.size() < 2) return fail("expected: plan Basic|Standard|Premium|none [category=A,B] [income=MIN-MAX] [hostel|day]");
+            if (parse_mess_plan(w[1], plan)) r.plan = (int)plan;
+            else if (w[1] != "none") return fail("unknown mess plan '" + w[1] + "'");
+            for (size_t i = 2; i < w.size(); ++i) {
+                if (w[i] == "hostel") r.residence = MessResidence::Hostel;
+                else if (w[i] == "day") r.residence = MessResidence::Day;
+                else if (w[i].compare(0, 9, "category=") == 0) {
+                    string bad;
+                    if (!parse_category_set(w[i].substr(9), r.categories, bad)) return fail("unknown category '" + bad + "'");
+                } else if (w[i].compare(0, 7, "income=") == 0) {
+                    if (!parse_income_band(w[i].substr(7), r.min_income, r.max_income)) return fail("bad income band in '" + w[i] + "'");
+                } else {
+                    return fail("unknown plan option '" + w[i] + "'");
+                }
+            }
+            out.plan_rules.push_back(r);
+        } else {
+            return fail("unknown entry '" + kind + "'");
+        }
+    }
+    *this = std::move(out);
+    return true;
+}
+
+bool CampusConfig::load(const string& path, string& error) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    int64_t mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    string cache = path + ".bin";
+    if (read_cache(cache, (uint64_t)st.st_size, mtime)) return true;
+
+    ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    if (!parse(in, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    write_cache(cache, (uint64_t)st.st_size, mtime);    // best effort
+    return true;
+}
+
+// Maps the image and copies it out. Any mismatch with the source file or
+// any record pointing outside the image means a rebuild, not an error.
+bool CampusConfig::read_cache(const string& path, uint64_t source_size, int64_t source_mtime) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CampusCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    const char* base = static_cast<const char*>(map);
+
+    CampusCacheHeader h;
+    memcpy(&h, base, sizeof h);
+    uint64_t expected = sizeof(CampusCacheHeader) + (uint64_t)h.mess_count * sizeof(CachedMess) +
+                        (uint64_t)h.university_count * sizeof(CachedUniversity) +
+                        (uint64_t)h.branch_count * sizeof(CachedBranch) +
+                        (uint64_t)h.hostel_count * sizeof(CachedHostel) +
+                        (uint64_t)h.block_count * sizeof(CachedBlock) +
+                        (uint64_t)h.rule_count * sizeof(CachedPlanRule) + h.string_bytes;
+    bool ok = h.magic == CampusCacheHeader::MAGIC && h.version == CampusCacheHeader::VERSION &&
+              h.source_size == source_size && h.source_mtime == source_mtime && expected == size &&
+              h.mess_count <= (uint32_t)MAX_MESS_OUTLETS;
+
+    CampusConfig out;
+    if (ok) {
+        const auto* messes = reinterpret_cast<const CachedMess*>(base + sizeof(CampusCacheHeader));
+        const auto* unis = reinterpret_cast<const CachedUniversity*>(messes + h.mess_count);
+        const auto* brs = reinterpret_cast<const CachedBranch*>(unis + h.university_count);
+        const auto* hostels = reinterpret_cast<const CachedHostel*>(brs + h.branch_count);
+        const auto* blocks = reinterpret_cast<const CachedBlock*>(hostels + h.hostel_count);
+        const auto* rules = reinterpret_cast<const CachedPlanRule*>(blocks + h.block_count);
+        const char* strings = reinterpret_cast<const char*>(rules + h.rule_count);
+        auto name = [&](const CachedName& n, string& to) {
+            if ((uint64_t)n.offset + n.length > h.string_bytes) return false;
+            to.assign(strings + n.offset, n.length);
+            return true;
+        };
+
+        for (uint32_t i = 0; ok && i < h.mess_count; ++i) {
+            const CachedMess& cm = messes[i];
+            out.messes.push_back(MessSpec{"", cm.capacity, {cm.prices[0], cm.prices[1], cm.prices[2]}});
+            ok = name(cm.name, out.messes.back().name);
+        }
+        for (uint32_t i = 0; ok && i < h.rule_count; ++i) {
+            const CachedPlanRule& cr = rules[i];
+            ok = cr.residence <= (uint32_t)MessResidence::Day && cr.plan >= NO_MESS_PLAN &&
+                 cr.plan < (int)MESS_PLANS.size();
+            out.plan_rules.push_back({(uint8_t)cr.categories, cr.min_income, cr.max_income,
+                                      (MessResidence)cr.residence, cr.plan});
+        }
+        out.hostels.resize(h.hostel_count);
+        uint64_t next_block = 0;
+        for (uint32_t i = 0; ok && i < h.hostel_count; ++i) {
+            const CachedHostel& ch = hostels[i];
+            HostelSpec& hs = out.hostels[i];
+            ok = name(ch.name, hs.name) && ch.residents <= (uint32_t)Residents::Any &&
+                 next_block + ch.block_count <= h.block_count;
+            if (!ok) break;
+            hs.residents = (Residents)ch.residents;
+            hs.priority = ch.priority;
+            hs.blocks.resize(ch.block_count);
+            for (HostelBlockSpec& b : hs.blocks) {
+                const CachedBlock& cb = blocks[next_block++];
+                ok = ok && name(cb.name, b.name);
+                b.floors = cb.floors;
+                b.rooms_per_floor = cb.rooms_per_floor;
+                b.beds_per_room = cb.beds_per_room;
+            }
+        }
+        ok = ok && next_block == h.block_count;
+        out.universities.resize(h.university_count);
+        uint64_t next_branch = 0;
+        for (uint32_t i = 0; ok && i < h.university_count; ++i) {
+            const CachedUniversity& cu = unis[i];
+            UniversitySpec& u = out.universities[i];
+            ok = name(cu.name, u.name) && next_branch + cu.branch_count <= h.branch_count;
+            if (!ok) break;
+            u.opening_rank = cu.opening_rank;
+            u.closing_rank = cu.closing_rank;
+            u.merit_first = cu.policy & 1;
+            u.share_ties = cu.policy & 2;
+            u.branches.resize(cu.branch_count);
+            for (BranchSpec& b : u.branches) {
+                const CachedBranch& cb = brs[next_branch++];
+                ok = ok && name(cb.name, b.name);
+                b.general_seats = cb.general_seats;
+                copy(cb.reserved, cb.reserved + CATEGORY_COUNT, b.reserved.begin());
+                b.opening_rank = cb.opening_rank;
+                b.closing_rank = cb.closing_rank;
+            }
+        }
+        ok = ok && next_branch == h.branch_count;
+    }
+    munmap(map, size);
+    if (ok) *this = std::move(out);
+    return ok;
+}
+
+// Written to a temporary file and renamed, so a reader never maps half an
+// image.
+bool CampusConfig::write_cache(const string& path, uint64_t source_size, int64_t source_mtime) const {
+    string strings;
+    auto name = [&strings](const string& str) {
+        CachedName n{(uint32_t)strings.size(), (uint32_t)str.size()};
+        strings += str;
+        return n;
+    };
+
+    CampusCacheHeader h{CampusCacheHeader::MAGIC, CampusCacheHeader::VERSION, source_size, source_mtime,
+                        (uint32_t)universities.size(), (uint32_t)branch_count(), (uint32_t)hostels.size(), 0, (uint32_t)messes.size(), (uint32_t)plan_rules.size(), 0};
+    vector<CachedMess> ms;
+    for (const MessSpec& spec : messes) {
+        CachedMess cm{name(spec.name), spec.capacity, {}};
+        copy(spec.prices.begin(), spec.prices.end(), cm.prices);
+        ms.push_back(cm);
+    }
+    vector<CachedPlanRule> rules;
+    for (const MessPlanRule& r : plan_rules) {
+        rules.push_back({r.categories, r.min_income, r.max_income, (uint32_t)r.residence, r.plan});
+    }
+    vector<CachedHostel> hs;
+    vector<CachedBlock> blocks;
+    for (const HostelSpec& spec : hostels) {
+        hs.push_back({name(spec.name), (uint32_t)spec.residents, spec.priority, (uint32_t)spec.blocks.size()});
+        for (const HostelBlockSpec& b : spec.blocks) {
+            blocks.push_back({name(b.name), b.floors, b.rooms_per_floor, b.beds_per_room});
+        }
+    }
+    h.block_count = (uint32_t)blocks.size();
+    vector<CachedUniversity> unis;
+    vector<CachedBranch> brs;
+    unis.reserve(universities.size());
+    brs.reserve(h.branch_count);
+    for (const auto& u : universities) {
+        unis.push_back({name(u.name), u.opening_rank, u.closing_rank,
+                        (uint32_t)((u.merit_first ? 1 : 0) | (u.share_ties ? 2 : 0)), (uint32_t)u.branches.size()});
+        for (const auto& b : u.branches) {
+            CachedBranch cb{name(b.name), b.general_seats, {}, b.opening_rank, b.closing_rank};
+            copy(b.reserved.begin(), b.reserved.end(), cb.reserved);
+            brs.push_back(cb);
+        }
+    }
+    h.string_bytes = (uint32_t)strings.size();
+
+    string tmp = path + ".tmp." + to_string(getpid());
+    ofstream out(tmp, ios::binary | ios::trunc);
+    out.write((const char*)&h, sizeof h);
+    out.write((const char*)ms.data(), ms.size() * sizeof(CachedMess));
+    out.write((const char*)unis.data(), unis.size() * sizeof(CachedUniversity));
+    out.write((const char*)brs.data(), brs.size() * sizeof(CachedBranch));
+    out.write((const char*)hs.data(), hs.size() * sizeof(CachedHostel));
+    out.write((const char*)blocks.data(), blocks.size() * sizeof(CachedBlock));
+    out.write((const char*)rules.data(), rules.size() * sizeof(CachedPlanRule));
+    out.write(strings.data(), strings.size());
+    out.close();
+    if (!out || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+CampusConfig default_campus() {
+    CampusConfig config;
+    istringstream in(DEFAULT_CAMPUS_CONFIG);
+    string error;
+    config.parse(in, error);
+    return config;
+}
+
+namespace {
+
+// "37.5%" -> 3750. At most two decimals and at most 100%.
+bool parse_basis_points(const string& word, int& out) {
+    if (word.size() < 2 || word.back() != '%') return false;
+    string num = word.substr(0, word.size() - 1);
+    size_t dot = num.find('.');
+    string whole = num.substr(0, dot), frac = dot == string::npos ? "" : num.substr(dot + 1);
+    if (whole.empty() || frac.size() > 2 || whole.size() > 3) return false;
+    for (char c : whole + frac) if (!isdigit((unsigned char)c)) return false;
+    frac.resize(2, '0');
+    out = stoi(whole) * 100 + stoi(frac);
+    return out <= 10000;
+}
+
+}
+
+// Replaces nothing on failure; error is "line N: reason".
+bool FeeSchedule::parse(istream& in, string& error) {
+    FeeSchedule out;
+    vector<string> w;
+    string line;
+    int line_no = 0;
+    auto fail = [&](const string& why) {
+        error = "line " + to_string(line_no) + ": " + why;
+        return false;
+    };
+    while (getline(in, line)) {
+        ++line_no;
+        if (!split_config_line(line, w)) return fail("unterminated quote");
+        if (w.empty()) continue;
+        const string& kind = w[0];
+
+        if (kind == "tuition") {
+            Tuition t{"", "", 0};
+            if ((w.size() != 3 && w.size() != 4) || w[1].empty()) return fail("expected: tuition \"university\" [\"branch\"] rupees");
+            t.university = w[1];
+            if (w.size() == 4) t.branch = w[2];
+            if (!parse_config_int(w.back(), t.rupees) || t.rupees < 0 || t.rupees > MAX_TUITION) {
+                return fail("bad tuition for " + t.university);
+            }
+            for (const Tuition& other : out.tuition) {
+                if (other.university == t.university && other.branch == t.branch) return fail("duplicate tuition for " + t.university);
+            }
+            out.tuition.push_back(std::move(t));
+        } else if (kind == "hostel") {
+            int rent;
+            if (w.size() != 3 || w[1].empty()) return fail("expected: hostel \"name\" rupees");
+            if (!parse_config_int(w[2], rent) || rent < 0 || rent > MAX_MONTHLY) return fail("bad rent for " + w[1]);
+            for (const auto& other : out.hostel_rent) {
+                if (other.first == w[1]) return fail("duplicate hostel " + w[1]);
+            }
+            out.hostel_rent.emplace_back(w[1], rent);
+        } else if (kind == "waiver") {
+            Waiver v{"", 0, 0, INT_MAX, {0, 0, 0}};
+            if (w.size() < 3 || w[1].empty()) return fail("expected: waiver \"name\" [category=A,B] [income=MIN-MAX] tuition|hostel|mess=P% ...");
+            v.name = w[1];
+            for (size_t i = 2; i < w.size(); ++i) {
+                size_t eq = w[i].find('=');
+                string key = w[i].substr(0, eq), value = eq == string::npos ? "" : w[i].substr(eq + 1);
+                string bad;
+                if (key == "category") {
+                    if (!parse_category_set(value, v.categories, bad)) return fail("unknown category '" + bad + "'");
+                } else if (key == "income") {
+                    if (!parse_income_band(value, v.min_income, v.max_income)) return fail("bad income band in '" + w[i] + "'");
+                } else if (key == "tuition" || key == "hostel" || key == "mess") {
+                    int charge = key == "tuition" ? 0 : key == "hostel" ? 1 : 2;
+                    if (!parse_basis_points(value, v.basis_points[charge])) return fail("bad percentage in '" + w[i] + "'");
+                } else {
+                    return fail("unknown waiver option '" + w[i] + "'");
+                }
+            }
+            if (out.waivers.size() == (size_t)MAX_WAIVERS) return fail("more than " + to_string(MAX_WAIVERS) + " waivers");
+            out.waivers.push_back(std::move(v));
+        } else {
+            return fail("unknown entry '" + kind + "'");
+        }
+    }
+    *this = std::move(out);
+    return true;
+}
+
+bool FeeSchedule::load(const string& path, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    if (!parse(in, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+string format_paise(Paise p) {
+    string out = p < 0 ? "-" : "";
+    Paise a = p < 0 ? -p : p;
+    out += to_string(a / 100);
+    out += '.';
+    out += (char)('0' + a % 100 / 10);
+    out += (char)('0' + a % 10);
+    return out;
+}
+
+BillingCycle::BillingCycle(int cycle_) :
+    cycle(std::max(1, std::min((int)FeeSchedule::CYCLES, cycle_)))
+{ }
+
+void BillingCycle::reserve(size_t students) {
+    handle.reserve(students);
+    income.reserve(students);
+    category_bit.reserve(students);
+    tuition_fee.reserve(students);
+    hostel_rent.reserve(students);
+    mess_price.reserve(students);
+}
+
+// Fees are clamped to the schedule's limits; the fee file already holds
+// tuition and rent to them, so only an outsized mess price is cut.
+void BillingCycle::add(ApplicantHandle h, const Student& s, int tuition_rupees, int hostel_rupees, int mess_rupees) {
+    handle.push_back(h);
+    income.push_back(s.get_income());
+    category_bit.push_back(1u << (int)s.get_category_code());
+    tuition_fee.push_back((uint32_t)std::max(0, std::min(tuition_rupees, (int)FeeSchedule::MAX_TUITION)));
+    hostel_rent.push_back((uint32_t)std::max(0, std::min(hostel_rupees, (int)FeeSchedule::MAX_MONTHLY)));
+    mess_price.push_back((uint32_t)std::max(0, std::min(mess_rupees, (int)FeeSchedule::MAX_MONTHLY)));
+}
+
+namespace {
+
+// bp basis points of x, rounded down, without leaving 32 bits.
+inline uint32_t basis_share(uint32_t x, uint32_t bp) {
+    return x / 10000 * bp + x % 10000 * bp / 10000;
+}
+
+}
+
+// Students are taken in blocks of 64, the input columns padded with zero
+// fees, so every inner loop has a fixed trip count and only 32-bit lanes;
+// conditions become all-ones masks and selects. Waivers are applied last
+// to first, each overwriting where it matches, which leaves the first
+// match in place.
+BillingCycle::Report BillingCycle::compute(const FeeSchedule& fees) {
+    auto start = chrono::steady_clock::now();
+    const size_t n = size(), padded = (n + 63) / 64 * 64;
+    for (auto* col : {&category_bit, &tuition_fee, &hostel_rent, &mess_price}) col->resize(padded, 0);
+    income.resize(padded, 0);
+    tuition.resize(padded);
+    hostel.resize(padded);
+    mess.resize(padded);
+    waiver.resize(padded);
+    total.resize(padded);
+    waiver_rule.resize(padded);
+
+    const uint32_t last = cycle == FeeSchedule::CYCLES;
+    int64_t sums[6] = {0, 0, 0, 0, 0, 0};     // tuition, hostel, mess, waived, total, waived students
+    for (size_t b = 0; b < padded; b += 64) {
+        const int32_t* inc = income.data() + b;
+        const uint32_t* cat = category_bit.data() + b;
+        const uint32_t* fee = tuition_fee.data() + b;
+        const uint32_t* rent = hostel_rent.data() + b;
+        const uint32_t* price = mess_price.data() + b;
+        uint32_t t[64], h[64], m[64], off_t[64], off_h[64], off_m[64], w[64], due[64];
+        int32_t rule[64];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t annual = fee[i] * 100;
+            uint32_t monthly = annual / FeeSchedule::CYCLES;
+            t[i] = monthly + (annual - monthly * FeeSchedule::CYCLES) * last;
+            h[i] = rent[i] * 100;
+            m[i] = price[i] * 100;
+            off_t[i] = off_h[i] = off_m[i] = 0;
+            rule[i] = -1;
+        }
+        for (size_t k = fees.waivers.size(); k-- > 0;) {
+            const FeeSchedule::Waiver& v = fees.waivers[k];
+            const uint32_t cats = v.categories ? v.categories : 0xFFu;
+            const int lo = v.min_income, hi = v.max_income;
+            const uint32_t id = (uint32_t)k, bp_t = v.basis_points[0], bp_h = v.basis_points[1],
+                           bp_m = v.basis_points[2];
+            for (int i = 0; i < 64; ++i) {
+                uint32_t match = 0u - (uint32_t)(((cat[i] & cats) != 0) & (inc[i] >= lo) & (inc[i] <= hi));
+                rule[i] = (int32_t)(((uint32_t)rule[i] & ~match) | (id & match));
+                off_t[i] = (off_t[i] & ~match) | (bp_t & match);
+                off_h[i] = (off_h[i] & ~match) | (bp_h & match);
+                off_m[i] = (off_m[i] & ~match) | (bp_m & match);
+            }
+        }
+        for (int i = 0; i < 64; ++i) {
+            w[i] = basis_share(t[i], off_t[i]) + basis_share(h[i], off_h[i]) + basis_share(m[i], off_m[i]);
+            due[i] = t[i] + h[i] + m[i] - w[i];
+        }
+        for (int i = 0; i < 64; ++i) {
+            sums[0] += t[i];
+            sums[1] += h[i];
+            sums[2] += m[i];
+            sums[3] += w[i];
+            sums[4] += due[i];
+            sums[5] += rule[i] >= 0;
+        }
+        copy(t, t + 64, tuition.begin() + b);
+        copy(h, h + 64, hostel.begin() + b);
+        copy(m, m + 64, mess.begin() + b);
+        copy(w, w + 64, waiver.begin() + b);
+        copy(due, due + 64, total.begin() + b);
+        copy(rule, rule + 64, waiver_rule.begin() + b);
+    }
+    for (auto* col : {&category_bit, &tuition_fee, &hostel_rent, &mess_price, &tuition, &hostel, &mess, &waiver, &total}) {
+        col->resize(n);
+    }
+    income.resize(n);
+    waiver_rule.resize(n);
+
+    Report r{cycle, n, (size_t)sums[5], sums[0], sums[1], sums[2], sums[3], sums[4], 0};
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+// One CSV row per student in column order, built in a buffer that is
+// flushed every megabyte.
+bool BillingCycle::write_invoices(const string& path, const ApplicantStore& store, const FeeSchedule& fees) const {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+    string buf = "Roll,Name,Cycle,Tuition,Hostel_Rent,Mess,Waiver,Scheme,Amount_Due\n";
+    for (size_t i = 0; i < total.size(); ++i) {
+        const Student& s = store[handle[i]];
+        buf += to_string(s.get_roll());
+        buf += ",\"";
+        buf += s.get_name();
+        buf += "\",";
+        buf += to_string(cycle);
+        for (uint32_t p : {tuition[i], hostel[i], mess[i], waiver[i]}) {
+            buf += ',';
+            buf += format_paise(p);
+        }
+        buf += ",\"";
+        if (waiver_rule[i] >= 0) buf += fees.waivers[waiver_rule[i]].name;
+        buf += "\",";
+        buf += format_paise(total[i]);
+        buf += '\n';
+        if (buf.size() >= (1u << 20)) {
+            out.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+    out.write(buf.data(), buf.size());
+    return (bool)out;
+}
+
+void BillingCycle::Report::print() const {
+    ostringstream line;
+    line << "Billing cycle " << cycle << "/" << FeeSchedule::CYCLES << ": " << students << " students ("
+         << waived_students << " with a waiver) | tuition Rs" << format_paise(tuition)
+         << " | hostel Rs" << format_paise(hostel) << " | mess Rs" << format_paise(mess)
+         << " | waived Rs" << format_paise(waived) << " | due Rs" << format_paise(total)
+         << " | " << fixed << setprecision(3) << seconds << "s";
+    cout << line.str() << endl;
+}
+
+// Replaces nothing on failure; error is "line N: reason".
+bool ScholarshipCatalog::parse(istream& in, string& error) {
+    ScholarshipCatalog out;
+    vector<string> w;
+    string line;
+    int line_no = 0;
+    auto fail = [&](const string& why) {
+        error = "line " + to_string(line_no) + ": " + why;
+        return false;
+    };
+    while (getline(in, line)) {
+        ++line_no;
+        if (!split_config_line(line, w)) return fail("unterminated quote");
+        if (w.empty()) continue;
+        if (w[0] != "scheme") return fail("unknown entry '" + w[0] + "'");
+
+        Scheme s{"", 0, 0, INT_MAX, 0, -1, 0};
+        if (w.size() < 3 || w[1].empty()) return fail("expected: scheme \"name\" [category=A,B] [income=MIN-MAX] [marks=N] award=N [budget=N]");
+        s.name = w[1];
+        for (size_t i = 2; i < w.size(); ++i) {
+            size_t eq = w[i].find('=');
+            string key = w[i].substr(0, eq), value = eq == string::npos ? "" : w[i].substr(eq + 1);
+            string bad;
+            if (key == "category") {
+                if (!parse_category_set(value, s.categories, bad)) return fail("unknown category '" + bad + "'");
+            } else if (key == "income") {
+                if (!parse_income_band(value, s.min_income, s.max_income)) return fail("bad income band in '" + w[i] + "'");
+            } else if (key == "marks") {
+                if (!parse_config_int(value, s.min_percentage) || s.min_percentage < 0 || s.min_percentage > 100)
+                    return fail("bad percentage in '" + w[i] + "'");
+            } else if (key == "award") {
+                if (!parse_config_int(value, s.award) || s.award < 0) return fail("bad award for " + s.name);
+            } else if (key == "budget") {
+                char* end = nullptr;
+                errno = 0;
+                s.budget = value.empty() ? -1 : strtoll(value.c_str(), &end, 10);
+                if (value.empty() || *end || errno || s.budget < 0 || s.budget > INT64_MAX / 100)
+                    return fail("bad budget for " + s.name);
+            } else {
+                return fail("unknown scheme option '" + w[i] + "'");
+            }
+        }
+        if (s.award < 0) return fail("scheme " + s.name + " has no award");
+        for (const Scheme& other : out.schemes) {
+            if (other.name == s.name) return fail("duplicate scheme " + s.name);
+        }
+        if (out.schemes.size() == (size_t)MAX_SCHEMES) return fail("more than " + to_string(MAX_SCHEMES) + " schemes");
+        out.schemes.push_back(std::move(s));
+    }
+    *this = std::move(out);
+    return true;
+}
+
+bool ScholarshipCatalog::load(const string& path, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    if (!parse(in, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+void ScholarshipRound::reserve(size_t students) {
+    handle.reserve(students);
+    income.reserve(students);
+    category_bit.reserve(students);
+    percentage.reserve(students);
+}
+
+void ScholarshipRound::add(ApplicantHandle h, const Student& s) {
+    handle.push_back(h);
+    income.push_back(s.get_income());
+    category_bit.push_back((uint8_t)(1u << (int)s.get_category_code()));
+    percentage.push_back((uint8_t)s.get_percentage_12th());
+}
+
+void ScholarshipRound::add_admitted(const ApplicantStore& store) {
+    reserve(size() + store.size());
+    for (auto it = store.begin(); it != store.end(); ++it) {
+        if ((*it).is_admitted()) add(it.handle(), *it);
+    }
+}
+
+// The columns are copied into blocks padded to 64 with students no scheme
+// can match, so every inner loop has a fixed trip count the compiler can
+// vectorize.
+ScholarshipRound::Report ScholarshipRound::evaluate(const ScholarshipCatalog& catalog) {
+    auto start = chrono::steady_clock::now();
+    const size_t n = size(), words = (n + 63) / 64, schemes = catalog.schemes.size();
+    vector<int32_t> inc(income);
+    vector<uint8_t> cat(category_bit), pct(percentage);
+    inc.resize(words * 64, 0);
+    cat.resize(words * 64, 0);
+    pct.resize(words * 64, 0);
+
+    eligible.assign(schemes, vector<uint64_t>(words, 0));
+    awards.assign(schemes, vector<uint32_t>());
+    results.assign(schemes, Result{0, 0, 0, false});
+    for (size_t w = 0; w < words; ++w) {
+        const int32_t* block_income = inc.data() + w * 64;
+        const uint8_t* block_cat = cat.data() + w * 64;
+        const uint8_t* block_pct = pct.data() + w * 64;
+        for (size_t s = 0; s < schemes; ++s) {
+            const ScholarshipCatalog::Scheme& sc = catalog.schemes[s];
+            const uint8_t cats = sc.categories ? sc.categories : 0xFF;
+            const int lo = sc.min_income, hi = sc.max_income;
+            const uint8_t marks = (uint8_t)sc.min_percentage;
+            uint8_t hit[64];
+            for (int i = 0; i < 64; ++i) {
+                hit[i] = ((block_cat[i] & cats) != 0) & (block_income[i] >= lo) & (block_income[i] <= hi) &
+                         (block_pct[i] >= marks);
+            }
+            uint64_t bits = 0;
+            for (int i = 0; i < 64; ++i) bits |= (uint64_t)hit[i] << i;
+            eligible[s][w] = bits;
+        }
+    }
+
+    Report r{n, schemes, 0, 0, 0, 0};
+    for (size_t s = 0; s < schemes; ++s) {
+        const ScholarshipCatalog::Scheme& sc = catalog.schemes[s];
+        Result& res = results[s];
+        const Paise award = (Paise)sc.award * 100;
+        Paise left = sc.budget * 100;
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t bits = eligible[s][w];
+            res.eligible += __builtin_popcountll(bits);
+            while (bits && !res.capped) {
+                uint32_t i = (uint32_t)(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                if (sc.budget > 0 && left < award) {
+                    res.capped = true;
+                    break;
+                }
+                left -= award;
+                awards[s].push_back(i);
+                res.granted += award;
+            }
+        }
+        res.awarded = awards[s].size();
+        r.eligible += res.eligible;
+        r.awards += res.awarded;
+        r.granted += res.granted;
+    }
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+bool ScholarshipRound::is_eligible(size_t scheme, size_t student) const {
+    return scheme < eligible.size() && student < size() && (eligible[scheme][student >> 6] >> (student & 63) & 1);
+}
+
+void ScholarshipRound::Report::print() const {
+    ostringstream line;
+    line << "Scholarships: " << schemes << " schemes x " << students << " students | " << eligible
+         << " eligible | " << awards << " awards | Rs" << format_paise(granted) << " granted | "
+         << fixed << setprecision(3) << seconds << "s";
+    cout << line.str() << endl;
+}
+
+void ScholarshipRound::print_results(const ScholarshipCatalog& catalog) const {
+    for (size_t s = 0; s < results.size() && s < catalog.schemes.size(); ++s) {
+        const Result& res = results[s];
+        cout << catalog.schemes[s].name << ": " << res.eligible << " eligible, " << res.awarded
+             << " awarded, Rs" << format_paise(res.granted) << (res.capped ? " (budget spent)" : "") << endl;
+    }
+}
+
+// One CSV row per award, scheme by scheme in merit order.
+bool ScholarshipRound::write_awards(const string& path, const ApplicantStore& store, const ScholarshipCatalog& catalog) const {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+    string buf = "Scheme,Roll,Name,JEE_Rank,Amount\n";
+    for (size_t s = 0; s < awards.size() && s < catalog.schemes.size(); ++s) {
+        string amount = format_paise((Paise)catalog.schemes[s].award * 100);
+        for (uint32_t i : awards[s]) {
+            const Student& st = store[handle[i]];
+            buf += '"';
+            buf += catalog.schemes[s].name;
+            buf += "\",";
+            buf += to_string(st.get_roll());
+            buf += ",\"";
+            buf += st.get_name();
+            buf += "\",";
+            buf += to_string(st.jee_rank);
+            buf += ',';
+            buf += amount;
+            buf += '\n';
+            if (buf.size() >= (1u << 20)) {
+                out.write(buf.data(), buf.size());
+                buf.clear();
+            }
+        }
+    }
+    out.write(buf.data(), buf.size());
+    return (bool)out;
+}
+
+// Binary, host order: "SCHB", student and scheme counts (u32), the rolls
+// in column order (i32 each), then per scheme its eligibility bitmap
+// ((students + 63) / 64 u64 words, bit i for the i-th roll).
+bool ScholarshipRound::write_bitmaps(const string& path, const ApplicantStore& store) const {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+    const uint32_t header[3] = {0x42484353, (uint32_t)size(), (uint32_t)eligible.size()};
+    out.write((const char*)header, sizeof header);
+    vector<int32_t> rolls;
+    rolls.reserve(size());
+    for (ApplicantHandle h : handle) rolls.push_back(store[h].get_roll());
+    out.write((const char*)rolls.data(), rolls.size() * sizeof(int32_t));
+    for (const auto& bits : eligible) out.write((const char*)bits.data(), bits.size() * sizeof(uint64_t));
+    return (bool)out;
+}
+
+namespace {
+
+const array<string, MEAL_SLOTS> MEALS = {"Breakfast", "Lunch", "Snacks", "Dinner"};
+
+// Serving hours in minutes after local midnight, [open, close).
+const array<pair<int, int>, MEAL_SLOTS> MEAL_HOURS = {{
+    {7 * 60, 10 * 60}, {12 * 60, 15 * 60}, {16 * 60, 18 * 60}, {19 * 60, 22 * 60 + 30},
+}};
+
+}
+
+const string& meal_name(Meal m) { return MEALS[(int)m]; }
+
+MessAttendance::MessAttendance(int outlets_, unsigned shard_count, int utc_offset_seconds) :
+    outlets(std::max(1, std::min(MAX_MESS_OUTLETS, outlets_))),
+    utc_offset(utc_offset_seconds),
+    plan_by_roll(),
+    shards(),
+    latest(-1)
+{
+    shard_count = std::max(1u, shard_count);
+    for (unsigned i = 0; i < shard_count; ++i) {
+        auto shard = make_unique<Shard>();
+        for (Bucket& b : shard->ring) {
+            b.slot.store(-1, memory_order_relaxed);
+            b.counts = vector<atomic<uint32_t>>(outlets * PLANS);
+        }
+        for (auto& t : shard->taps) t.store(0, memory_order_relaxed);
+        shards.push_back(std::move(shard));
+    }
+}
+
+void MessAttendance::set_plan(int roll, MessPlan plan) {
+    if (roll <= 0) return;
+    if ((size_t)roll >= plan_by_roll.size()) plan_by_roll.resize(roll + 1, PLANS);
+    plan_by_roll[roll] = (uint8_t)plan;
+}
+
+void MessAttendance::load_roster(const AdmissionSnapshot& snap) {
+    for (const StudentView& v : *snap.students) {
+        MessPlan plan;
+        if (v.mess && parse_mess_plan(v.mess_plan, plan)) set_plan(v.roll, plan);
+    }
+}
+
+int64_t MessAttendance::slot_of(int64_t time) const {
+    int64_t local = time + utc_offset;
+    int64_t day = local >= 0 ? local / 86400 : (local - 86399) / 86400;
+    int minute = (int)((local - day * 86400) / 60);
+    for (int m = 0; m < MEAL_SLOTS; ++m) {
+        if (minute >= MEAL_HOURS[m].first && minute < MEAL_HOURS[m].second) return day * MEAL_SLOTS + m;
+    }
+    return -1;
+}
+
+bool MessAttendance::parse_tap(string_view line, MealTap& out) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    const char* p = line.data();
+    const char* end = p + line.size();
+    auto field = [&](auto& v, bool last) {
+        auto r = from_chars(p, end, v);
+        if (r.ec != errc()) return false;
+        p = r.ptr;
+        if (last) return p == end;
+        if (p == end || *p != ',') return false;
+        ++p;
+        return true;
+    };
+    return field(out.time, false) && field(out.outlet, false) && field(out.roll, true) && out.time >= 0;
+}
+
+// Only shard's own thread calls this, so the counters are bumped with a
+// relaxed load and store. Recycling a bucket marks it RECYCLING before the
+// counts are cleared; readers that see the mark, or see the slot change
+// under them, discard what they read.
+MessAttendance::Tap MessAttendance::record(unsigned shard, const MealTap& tap) {
+    Shard& sh = *shards[shard % shards.size()];
+    auto bump = [](atomic<uint64_t>& c) { c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed); };
+    Tap result = Tap::Counted;
+    int64_t slot = -1;
+    uint8_t plan = PLANS;
+    if (tap.outlet < 0 || tap.outlet >= outlets || tap.roll <= 0 || tap.time < 0) result = Tap::Malformed;
+    else if ((size_t)tap.roll >= plan_by_roll.size() || (plan = plan_by_roll[tap.roll]) == PLANS) result = Tap::UnknownStudent;
+    else if ((slot = slot_of(tap.time)) < 0) result = Tap::OffHours;
+    else if (slot + RING_SLOTS <= latest.load(memory_order_relaxed)) result = Tap::Late;
+
+    if (result == Tap::Counted) {
+        Bucket& b = sh.ring[slot % RING_SLOTS];
+        int64_t held = b.slot.load(memory_order_relaxed);
+        if (held > slot) {
+            result = Tap::Late;
+        } else {
+            if (held < slot) {
+                b.slot.store(RECYCLING, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                for (auto& c : b.counts) c.store(0, memory_order_relaxed);
+                b.slot.store(slot, memory_order_release);
+            }
+            auto& c = b.counts[tap.outlet * PLANS + plan];
+            c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+            int64_t seen = latest.load(memory_order_relaxed);
+            while (seen < slot && !latest.compare_exchange_weak(seen, slot, memory_order_release, memory_order_relaxed)) { }
+        }
+    }
+    bump(sh.taps[(int)result]);
+    return result;
+}
+
+// The calling thread reads up to 1 MiB at a time and hands the complete
+// lines to one worker per shard through a bounded queue, so a slow pipe is
+// counted as it arrives.
+size_t MessAttendance::ingest(int fd) {
+    BoundedQueue<string> blocks(2 * shards.size());
+    vector<thread> workers;
+    for (unsigned s = 0; s < shards.size(); ++s) {
+        workers.emplace_back([this, s, &blocks] {
+            string block;
+            MealTap tap;
+            while (blocks.pop(block)) {
+                string_view rest(block);
+                while (!rest.empty()) {
+                    size_t nl = rest.find('\n');
+                    string_view line = rest.substr(0, nl);
+                    rest = nl == string_view::npos ? string_view() : rest.substr(nl + 1);
+                    if (line.empty()) continue;
+                    if (parse_tap(line, tap)) record(s, tap);
+                    else {
+                        auto& c = shards[s]->taps[(int)Tap::Malformed];
+                        c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+                    }
+                }
+            }
+        });
+    }
+
+    const size_t BLOCK = 1 << 20;
+    size_t lines = 0;
+    string pending;
+    vector<char> buf(BLOCK);
+    while (true) {
+        ssize_t n = read(fd, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        pending.append(buf.data(), (size_t)n);
+        size_t cut = pending.rfind('\n');
+        if (cut == string::npos) continue;
+        string rest = pending.substr(cut + 1);
+        pending.resize(cut + 1);
+        lines += count(pending.begin(), pending.end(), '\n');
+        blocks.push(std::move(pending));
+        pending = std::move(rest);
+    }
+    if (!pending.empty()) {
+        lines += count(pending.begin(), pending.end(), '\n') + (pending.back() != '\n');
+        blocks.push(std::move(pending));
+    }
+    blocks.close();
+    for (auto& w : workers) w.join();
+    return lines;
+}
+
+bool MessAttendance::read_bucket(const Bucket& b, int64_t slot, vector<uint64_t>& into) const {
+    if (slot < 0 || b.slot.load(memory_order_acquire) != slot) return false;
+    for (size_t i = 0; i < into.size(); ++i) into[i] = b.counts[i].load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    return b.slot.load(memory_order_relaxed) == slot;
+}
+
+MessAttendance::Headcount MessAttendance::headcount(int64_t slot) const {
+    Headcount out(outlets, array<uint64_t, PLANS>{});
+    vector<uint64_t> counts(outlets * PLANS);
+    for (const auto& sh : shards) {
+        if (!read_bucket(sh->ring[slot % RING_SLOTS], slot, counts)) continue;
+        for (int o = 0; o < outlets; ++o) {
+            for (int p = 0; p < PLANS; ++p) out[o][p] += counts[o * PLANS + p];
+        }
+    }
+    return out;
+}
+
+vector<uint64_t> MessAttendance::weekly_trend(int64_t slot, int outlet) const {
+    vector<uint64_t> out(TREND_SLOTS, 0);
+    vector<uint64_t> counts(outlets * PLANS);
+    for (int k = 0; k < TREND_SLOTS; ++k) {
+        int64_t s = slot - (TREND_SLOTS - 1) + k;
+        if (s < 0) continue;
+        for (const auto& sh : shards) {
+            if (!read_bucket(sh->ring[s % RING_SLOTS], s, counts)) continue;
+            for (int i = 0; i < outlets * PLANS; ++i) {
+                if (outlet < 0 || i / PLANS == outlet) out[k] += counts[i];
+            }
+        }
+    }
+    return out;
+}
+
+MessAttendance::Totals MessAttendance::totals() const {
+    Totals t{0, 0, 0, 0, 0};
+    for (const auto& sh : shards) {
+        t.counted += sh->taps[(int)Tap::Counted].load(memory_order_relaxed);
+        t.malformed += sh->taps[(int)Tap::Malformed].load(memory_order_relaxed);
+        t.unknown += sh->taps[(int)Tap::UnknownStudent].load(memory_order_relaxed);
+        t.off_hours += sh->taps[(int)Tap::OffHours].load(memory_order_relaxed);
+        t.late += sh->taps[(int)Tap::Late].load(memory_order_relaxed);
+    }
+    return t;
+}
+
+SeatIndex::SeatIndex() :
+    slots(),
+    slot_of(),
+    first_slot(1, 0),
+    university_of(),
+    full(),
+    out_of_window(),
+    by_opening(),
+    by_closing(),
+    opened(0),
+    closed(0),
+    sweep_rank(0)
+{ }
+
+void SeatIndex::build(const vector<unique_ptr<University>>& universities) {
+    MemoryScope mem(MEM_SEAT_STATE);
+    slots.clear();
+    slot_of.clear();
+    first_slot.assign(1, 0);
+    university_of.clear();
+    for (size_t u = 0; u < universities.size(); ++u) {
+        University* uni = universities[u].get();
+        if (uni) {
+            university_of.emplace(uni->get_name(), (uint32_t)u);
+            for (const auto& branch : uni->get_branches()) {
+                Branch* br = branch.second.get();
+                if (!br) continue;
+                int opening = std::max(uni->get_opening_rank(), br->get_opening_rank());
+                int closing = std::min(uni->get_closing_rank(), br->get_closing_rank());
+                if (opening > closing) opening = closing = INT_MAX;     // never admits anyone
+                slot_of.emplace_back(br->get_id(), (uint32_t)slots.size());
+                slots.push_back({uni, br, opening, closing});
+            }
+        }
+        sort(slot_of.begin() + first_slot.back(), slot_of.end());
+        first_slot.push_back((uint32_t)slot_of.size());
+    }
+
+    by_opening.resize(slots.size());
+    iota(by_opening.begin(), by_opening.end(), 0u);
+    by_closing = by_opening;
+    sort(by_opening.begin(), by_opening.end(),
+         [this](uint32_t a, uint32_t b) { return slots[a].opening_rank < slots[b].opening_rank; });
+    sort(by_closing.begin(), by_closing.end(),
+         [this](uint32_t a, uint32_t b) { return slots[a].closing_rank < slots[b].closing_rank; });
+    reset();
+}
+
+// Back to the start of a run: every window closed and the full sets
+// taken from the branches' current counts.
+void SeatIndex::reset() {
+    size_t words = (slots.size() + 63) / 64;
+    for (auto& bits : full) bits.assign(words, 0);
+    out_of_window.assign(words, ~0ull);
+    opened = closed = 0;
+    sweep_rank = 0;
+    for (uint32_t i = 0; i < slots.size(); ++i) refresh(i);
+}
+
+// Moving to a lower rank restarts the sweep; a merit-ordered run only
+// ever moves forward.
+void SeatIndex::seek(int rank) {
+    if (rank < sweep_rank) {
+        for (uint64_t& w : out_of_window) w = ~0ull;
+        opened = closed = 0;
+    }
+    sweep_rank = rank;
+    for (; opened < by_opening.size() && slots[by_opening[opened]].opening_rank <= rank; ++opened) {
+        set_bit(out_of_window, by_opening[opened], false);
+    }
+    for (; closed < by_closing.size() && slots[by_closing[closed]].closing_rank < rank; ++closed) {
+        set_bit(out_of_window, by_closing[closed], true);
+    }
+}
+
+void SeatIndex::refresh(uint32_t slot) {
+    const Branch& br = *slots[slot].branch;
+    bool general_left = br.general_remaining() > 0;
+    for (int c = 0; c < CATEGORY_COUNT; ++c) {
+        set_bit(full[c], slot, !general_left && br.reserved_remaining((Category)c) <= 0);
+    }
+}
+
+AdmissionOffice::AdmissionOffice() :
+    universities(),
+    boys_hostels(),
+    girls_hostels(),
+    shared_hostels(),
+    next_bed(0),
+    messes(),
+    plan_rules(),
+    current_snapshot(make_shared<const AdmissionSnapshot>()),
+    next_epoch(1),
+    snapshot_interval(0),
+    roster(nullptr),
+    campus(),
+    program_seats(),
+    seat_index(),
+    seat_index_stale(false)
+{ }
+
+// Universities built in code are recorded in the campus layout as they
+// stand when added.
+void AdmissionOffice::add_university(unique_ptr<University> u) {
+    if (!u) return;
+    CampusConfig::UniversitySpec spec{u->get_name(), u->get_opening_rank(), u->get_closing_rank(),
+                                      u->merit_first(), u->shares_ties(), {}};
+    for (const auto& branch : u->get_branches()) {
+        const Branch* br = branch.second.get();
+        if (!br) continue;
+        CampusConfig::BranchSpec b{br->get_name(), br->general_remaining(), {},
+                                   br->get_opening_rank(), br->get_closing_rank()};
+        for (int c = 0; c < CATEGORY_COUNT; ++c) b.reserved[c] = br->reserved_remaining((Category)c);
+        spec.branches.push_back(std::move(b));
+    }
+    install_university(std::move(u), std::move(spec));
+    publish_snapshot();
+}
+
+void AdmissionOffice::add_university(const CampusConfig::UniversitySpec& spec) {
+    install_university(make_university(spec), spec);
+    publish_snapshot();
+}
+
+// Facilities the config declares replace the current ones; universities
+// are added after those already set up. One snapshot for the whole load.
+// Hostels, mess outlets and plan rules in the config replace the
+// office's own; the universities are added to it.
+void AdmissionOffice::load_campus(const CampusConfig& config) {
+    MemoryScope mem(MEM_SEAT_STATE);
+    if (!config.hostels.empty()) {
+        boys_hostels.clear();
+        girls_hostels.clear();
+        shared_hostels.clear();
+        campus.hostels.clear();
+        next_bed = 0;
+    }
+    for (const auto& spec : config.hostels) {
+        if (spec.residents == Residents::Boys) {
+            auto h = make_unique<BoysHostel>(spec.name, spec.blocks);
+            install_hostel(*h, spec);
+            boys_hostels.add(std::move(h), spec.priority);
+        } else if (spec.residents == Residents::Girls) {
+            auto h = make_unique<GirlsHostel>(spec.name, spec.blocks);
+            install_hostel(*h, spec);
+            girls_hostels.add(std::move(h), spec.priority);
+        } else {
+            auto h = make_unique<SharedHostel>(spec.name, spec.blocks);
+            install_hostel(*h, spec);
+            shared_hostels.add(std::move(h), spec.priority);
+        }
+    }
+    if (!config.messes.empty()) {
+        messes.clear();
+        campus.messes.clear();
+    }
+    for (const auto& spec : config.messes) {
+        auto m = make_unique<Mess>(spec.name, spec.capacity);
+        for (size_t p = 0; p < MESS_PLANS.size(); ++p) {
+            if (spec.prices[p] < 0) m->remove_plan(MESS_PLANS[p]);
+            else m->set_plan_price(MESS_PLANS[p], spec.prices[p]);
+        }
+        add_mess(std::move(m));
+    }
+    if (!config.plan_rules.empty()) {
+        plan_rules = MessPlanRules(config.plan_rules);
+        campus.plan_rules = config.plan_rules;
+    }
+    universities.reserve(universities.size() + config.universities.size());
+    campus.universities.reserve(campus.universities.size() + config.universities.size());
+    for (const auto& spec : config.universities) install_university(make_university(spec), spec);
+    publish_snapshot();
+}
+
+const CampusConfig& AdmissionOffice::get_campus() const { return campus; }
+
+void AdmissionOffice::install_university(unique_ptr<University> u, CampusConfig::UniversitySpec spec) {
+    MemoryScope mem(MEM_SEAT_STATE);
+    universities.push_back(std::move(u));
+    campus.universities.push_back(std::move(spec));
+    seat_index_stale = true;
+}
+
+// Called at the start of every run. The slot tables are rebuilt only if
+// universities were added since; otherwise just the bitsets are reset, so
+// seat counts changed outside the allocator are still picked up.
+void AdmissionOffice::reset_seat_index() {
+    if (!seat_index_stale) {
+        seat_index.reset();
+        return;
+    }
+    seat_index.build(universities);
+    program_seats.clear();
+    seat_index_stale = false;
+}
+
+// Extends the program seat table to every program interned so far.
+void AdmissionOffice::resolve_programs() {
+    MemoryScope mem(MEM_SEAT_STATE);
+    size_t count = program_count();
+    program_seats.reserve(count);
+    for (ProgramId id = (ProgramId)program_seats.size(); id < count; ++id) {
+        ProgramSeat seat{NO_SLOT, program_branch(id), false};
+        const string& university = program_university(id);
+        if (university.empty()) {
+            seat.any_university = true;
+        } else {
+            size_t u = seat_index.university(university);
+            if (u != SIZE_MAX) seat.slot = seat_index.find(u, seat.branch_id);
+        }
+        program_seats.push_back(seat);
+    }
+}
+
+// Gives the hostel the next range of campus bed numbers and records it.
+void AdmissionOffice::install_hostel(Hostel& hostel, CampusConfig::HostelSpec spec) {
+    hostel.set_first_bed(next_bed);
+    next_bed += (uint32_t)hostel.bed_count();
+    campus.hostels.push_back(std::move(spec));
+}
+
+// Replaces every hostel with one boys and one girls hostel.
+void AdmissionOffice::set_hostels(unique_ptr<BoysHostel> b, unique_ptr<GirlsHostel> g) {
+    boys_hostels.clear();
+    girls_hostels.clear();
+    shared_hostels.clear();
+    campus.hostels.clear();
+    next_bed = 0;
+    if (b) add_hostel(std::move(b));
+    if (g) add_hostel(std::move(g));
+    publish_snapshot();
+}
+
+void AdmissionOffice::add_hostel(unique_ptr<BoysHostel> h, int priority) {
+    if (!h) return;
+    install_hostel(*h, {h->get_name(), Residents::Boys, priority, h->get_blocks()});
+    boys_hostels.add(std::move(h), priority);
+}
+
+void AdmissionOffice::add_hostel(unique_ptr<GirlsHostel> h, int priority) {
+    if (!h) return;
+    install_hostel(*h, {h->get_name(), Residents::Girls, priority, h->get_blocks()});
+    girls_hostels.add(std::move(h), priority);
+}
+
+void AdmissionOffice::add_hostel(unique_ptr<SharedHostel> h, int priority) {
+    if (!h) return;
+    install_hostel(*h, {h->get_name(), Residents::Any, priority, h->get_blocks()});
+    shared_hostels.add(std::move(h), priority);
+}
+
+// Bed ranges are handed out in install order, so this is a scan over
+// the hostels, not over beds.
+const Hostel* AdmissionOffice::hostel_of(const Student& s) const {
+    if (!s.has_hostel()) return nullptr;
+    uint32_t bed = s.get_hostel_bed();
+    for (const auto& e : boys_hostels.get_entries()) if (e.hostel->holds(bed)) return e.hostel.get();
+    for (const auto& e : girls_hostels.get_entries()) if (e.hostel->holds(bed)) return e.hostel.get();
+    for (const auto& e : shared_hostels.get_entries()) if (e.hostel->holds(bed)) return e.hostel.get();
+    return nullptr;
+}
+
+// Replaces every outlet with this one.
+void AdmissionOffice::set_mess(unique_ptr<Mess> m) {
+    messes.clear();
+    campus.messes.clear();
+    if (m) add_mess(std::move(m));
+    publish_snapshot();
+}
+
+// Outlets are numbered in the order they are added; false once there are
+// MAX_MESS_OUTLETS.
+bool AdmissionOffice::add_mess(unique_ptr<Mess> m) {
+    if (!m || messes.size() == (size_t)MAX_MESS_OUTLETS) return false;
+    m->set_outlet((int)messes.size());
+    MessView v = m->view();
+    CampusConfig::MessSpec spec{v.name, v.capacity, {}};
+    for (size_t p = 0; p < MESS_PLANS.size(); ++p) {
+        spec.prices[p] = m->offers((MessPlan)p) ? m->get_plan_price(MESS_PLANS[p]) : -1;
+    }
+    campus.messes.push_back(std::move(spec));
+    messes.push_back(std::move(m));
+    return true;
+}
+
+const Mess* AdmissionOffice::mess_of(const Student& s) const {
+    if (!s.has_mess() || s.get_mess_outlet() >= (int)messes.size()) return nullptr;
+    return messes[s.get_mess_outlet()].get();
+}
+
+// An empty table restores the standard rules.
+void AdmissionOffice::set_mess_rules(vector<MessPlanRule> rules) {
+    campus.plan_rules = rules;
+    plan_rules = rules.empty() ? MessPlanRules() : MessPlanRules(std::move(rules));
+}
+
+const MessPlanRules& AdmissionOffice::get_mess_rules() const { return plan_rules; }
+
+// Gathers every admitted student's fees, university by university in
+// roster order, resolving names to numbers once per university, hostel
+// and outlet. Fees naming nothing on this campus are ignored.
+BillingCycle AdmissionOffice::billing_cycle(const ApplicantStore& store, const FeeSchedule& fees, int cycle) const {
+    BillingCycle bill(cycle);
+    unordered_map<const Hostel*, int> rent;
+    auto add_rent = [&](const Hostel& h) {
+        for (const auto& r : fees.hostel_rent) if (r.first == h.get_name()) rent[&h] = r.second;
+    };
+    for (const auto& e : boys_hostels.get_entries()) add_rent(*e.hostel);
+    for (const auto& e : girls_hostels.get_entries()) add_rent(*e.hostel);
+    for (const auto& e : shared_hostels.get_entries()) add_rent(*e.hostel);
+    vector<int> price(messes.size() * MESS_PLANS.size(), 0);    // [outlet * 3 + plan]
+    for (size_t m = 0; m < messes.size(); ++m) {
+        for (size_t p = 0; p < MESS_PLANS.size(); ++p) price[m * MESS_PLANS.size() + p] = messes[m]->get_plan_price(MESS_PLANS[p]);
+    }
+
+    size_t admitted = 0;
+    for (const auto& u : universities) admitted += u ? u->get_admitted().size() : 0;
+    bill.reserve(admitted);
+    for (const auto& u : universities) {
+        if (!u) continue;
+        int fallback = 0;
+        unordered_map<BranchId, int> by_branch;
+        for (const auto& t : fees.tuition) {
+            if (t.university != u->get_name()) continue;
+            BranchId id = t.branch.empty() ? NO_BRANCH : find_branch_id(t.branch);
+            if (t.branch.empty()) fallback = t.rupees;
+            else if (id != NO_BRANCH) by_branch[id] = t.rupees;
+        }
+        if (!u->holds_roster_of(store)) continue;
+        for (ApplicantHandle h : u->get_admitted()) {
+            if (!store.contains(h)) continue;
+            const Student& s = store[h];
+            auto t = by_branch.find(s.get_assigned_branch_id());
+            const Hostel* hostel = hostel_of(s);
+            auto r = hostel ? rent.find(hostel) : rent.end();
+            int mess_rupees = 0;
+            if (s.has_mess() && s.get_mess_outlet() < (int)messes.size())
+                mess_rupees = price[s.get_mess_outlet() * MESS_PLANS.size() + (int)s.get_mess_plan_code()];
+            bill.add(h, s, t != by_branch.end() ? t->second : fallback, r != rent.end() ? r->second : 0, mess_rupees);
+        }
+    }
+    return bill;
+}
+
+// Publish a new epoch every `students` admissions while a run is in
+// progress. 0 publishes only at the start and end of a run.
+void AdmissionOffice::set_snapshot_interval(size_t students) {
+    snapshot_interval = students;
+}
+
+shared_ptr<const AdmissionSnapshot> AdmissionOffice::build_snapshot(const ApplicantStore* applicants) const {
+    MemoryScope mem(MEM_REPORTS);
+    auto snap = make_shared<AdmissionSnapshot>();
+    snap->epoch = next_epoch;
+
+    snap->universities.reserve(universities.size());
+    for (const auto& uni_ptr : universities) {
+        if (!uni_ptr) continue;
+        snap->universities.push_back(uni_ptr->view(applicants ? applicants : roster));
+    }
+
+    for (const auto& e : boys_hostels.get_entries()) snap->hostels.push_back(e.hostel->view());
+    for (const auto& e : girls_hostels.get_entries()) snap->hostels.push_back(e.hostel->view());
+    for (const auto& e : shared_hostels.get_entries()) snap->hostels.push_back(e.hostel->view());
+    for (const auto& m : messes) snap->messes.push_back(m->view());
+    snap->stats = stats;
+
+    snap->students = applicants ? build_student_table(*applicants, *snap) : snapshot()->students;
+    return snap;
+}
+
+// Rows are rebuilt only for students whose RowState moved since the
+// current epoch. Unchanged chunks, the listing order and the roll index
+// are shared with it; a store from another generation starts over.
+shared_ptr<const StudentTable> AdmissionOffice::build_student_table(const ApplicantStore& applicants,
+                                                                    const AdmissionSnapshot& snap) const {
+    typedef StudentTable::RowState RowState;
+    const size_t CHUNK_ROWS = StudentTable::CHUNK_ROWS;
+
+    unordered_map<int, uint32_t> university_of;
+    for (uint32_t u = 0; u < snap.universities.size(); ++u) {
+        for (const auto& a : snap.universities[u].admitted) university_of[a.roll] = u;
+    }
+    auto state_of = [&university_of](const Student& s) {
+        RowState st{s.get_roll(), StudentTable::NO_UNIVERSITY, s.get_hostel_bed(), s.get_assigned_branch_id(),
+                    (uint8_t)(s.is_admitted() | s.has_hostel() << 1 | s.has_mess() << 2),
+                    (uint8_t)s.get_mess_plan_code(), (uint8_t)s.get_mess_outlet()};
+        if (s.is_admitted()) {
+            auto it = university_of.find(st.roll);
+            if (it != university_of.end()) st.university = it->second;
+        }
+        return st;
+    };
+    auto make_row = [this, &snap](const Student& s, const RowState& st) {
+        const Hostel* h = hostel_of(s);
+        const Mess* m = mess_of(s);
+        return StudentView{s.get_roll(), string(s.get_name()), s.jee_rank, s.get_percentage_12th(),
+                           s.get_age(), s.get_gender(), s.get_category(), s.is_eligible(),
+                           s.is_admitted(),
+                           st.university != StudentTable::NO_UNIVERSITY ? snap.universities[st.university].name : "",
+                           s.is_admitted() ? s.get_assigned_branch() : "",
+                           s.has_hostel(), h ? h->get_name() + " / " + h->describe_bed(s.get_hostel_bed()) : string(),
+                           s.has_mess(), s.get_mess_plan(), m ? m->get_name() : string()};
+    };
+
+    auto previous = snapshot()->students;
+    bool same_store = previous->generation == applicants.get_generation();
+    size_t n = applicants.size();
+    size_t previous_n = same_store ? previous->size() : 0;
+    bool rolls_moved = n < previous_n;
+
+    auto table = make_shared<StudentTable>();
+    table->generation = applicants.get_generation();
+    table->chunks.resize((n + CHUNK_ROWS - 1) / CHUNK_ROWS);
+    vector<RowState> states;
+    for (size_t c = 0; c < table->chunks.size(); ++c) {
+        ApplicantHandle first = (ApplicantHandle)(c * CHUNK_ROWS);
+        size_t rows = std::min(CHUNK_ROWS, n - first);
+        states.clear();
+        for (size_t i = 0; i < rows; ++i) states.push_back(state_of(applicants[first + i]));
+
+        const StudentTable::Chunk* old = same_store && c < previous->chunks.size() ? previous->chunks[c].get() : nullptr;
+        if (old && old->states == states) {
+            table->chunks[c] = previous->chunks[c];
+            continue;
+        }
+        auto chunk = make_shared<StudentTable::Chunk>();
+        chunk->rows.reserve(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            bool had_row = old && i < old->states.size();
+            if (had_row && old->states[i] == states[i]) {
+                chunk->rows.push_back(old->rows[i]);
+                continue;
+            }
+            if (had_row && old->states[i].roll != states[i].roll) rolls_moved = true;
+            chunk->rows.push_back(make_row(applicants[first + i], states[i]));
+        }
+        chunk->states = states;
+        table->chunks[c] = std::move(chunk);
+    }
+
+    const auto& listing = applicants.handles();
+    if (same_store && *previous->order == listing) table->order = previous->order;
+    else table->order = make_shared<const vector<ApplicantHandle>>(listing);
+
+    // Students appended since the previous epoch are sorted on their own
+    // and merged into its roll index.
+    if (!rolls_moved && n == previous_n) {
+        table->by_roll = previous->by_roll;
+    } else {
+        auto by_roll_less = [&table](ApplicantHandle a, ApplicantHandle b) {
+            return table->row(a).roll < table->row(b).roll;
+        };
+        size_t kept = rolls_moved ? 0 : previous_n;
+        auto index = make_shared<vector<ApplicantHandle>>();
+        index->reserve(n);
+        if (kept) index->assign(previous->by_roll->begin(), previous->by_roll->end());
+        for (size_t h = kept; h < n; ++h) index->push_back((ApplicantHandle)h);
+        sort(index->begin() + kept, index->end(), by_roll_less);
+        inplace_merge(index->begin(), index->begin() + kept, index->end(), by_roll_less);
+        table->by_roll = std::move(index);
+    }
+    return table;
+}
+
+// Writer side: only the thread running the office publishes. Readers pick
+// up whichever epoch is current and keep it alive for as long as they hold it.
+shared_ptr<const AdmissionSnapshot> AdmissionOffice::publish_snapshot() {
+    auto snap = build_snapshot(nullptr);
+    install_snapshot(snap);
+    return snap;
+}
+
+shared_ptr<const AdmissionSnapshot> AdmissionOffice::publish_snapshot(const ApplicantStore& applicants) {
+    roster = &applicants;
+    stats.follow(applicants.get_generation());
+    auto snap = build_snapshot(&applicants);
+    install_snapshot(snap);
+    return snap;
+}
+
+void AdmissionOffice::install_snapshot(const shared_ptr<const AdmissionSnapshot>& snap) {
+    ++next_epoch;
+    atomic_store(&current_snapshot, snap);
+    if (seat_table) seat_table->publish(*snap);
+}
+
+shared_ptr<const AdmissionSnapshot> AdmissionOffice::snapshot() const {
+    return atomic_load(&current_snapshot);
+}
+
+const AdmissionStats& AdmissionOffice::get_stats() const { return stats; }
+
+static MetricCounter& processed_metric =
+    metrics_registry().counter("admission_applications_processed_total", "Applications taken through a decision");
+static MetricCounter& admitted_metric =
+    metrics_registry().counter("admission_students_admitted_total", "Students admitted");
+static MetricCounter& ineligible_metric =
+    metrics_registry().counter("admission_students_rejected_total", "Students not admitted", "reason=\"ineligible\"");
+static MetricCounter& no_seat_metric =
+    metrics_registry().counter("admission_students_rejected_total", "Students not admitted", "reason=\"no_seat\"");
+static MetricCounter& skipped_probe_metric =
+    metrics_registry().counter("admission_seat_probes_skipped_total", "Preferences passed over by the seat index");
+static MetricHistogram& decision_latency_metric =
+    metrics_registry().histogram("admission_decision_latency_seconds", "Time to decide one application");
+static MetricHistogram& run_duration_metric =
+    metrics_registry().histogram("admission_run_duration_seconds", "Wall time of process_applications");
+static MetricGauge& run_active_metric =
+    metrics_registry().gauge("admission_run_in_progress", "1 while process_applications is running");
+
+void AdmissionOffice::export_metrics_to_file(const string& path, int interval_ms) {
+    metrics_file.reset();
+    metrics_file = make_unique<MetricsFileExporter>(path, chrono::milliseconds(interval_ms));
+}
+
+bool AdmissionOffice::export_metrics_on_socket(const string& path) {
+    metrics_socket.reset();
+    metrics_socket = make_unique<MetricsSocketExporter>(path);
+    return metrics_socket->is_listening();
+}
+
+// Creates (or takes over) the shared-memory segment `shm_name` and mirrors
+// every published epoch into it from now on.
+bool AdmissionOffice::share_seat_table(const string& shm_name) {
+    auto snap = snapshot();
+    uint32_t branches = 0;
+    for (const auto& u : snap->universities) branches += (uint32_t)u.branches.size();
+    seat_table.reset();
+    seat_table = make_unique<SeatTablePublisher>(shm_name, (uint32_t)snap->universities.size(), branches);
+    if (!seat_table->is_open()) {
+        seat_table.reset();
+        return false;
+    }
+    seat_table->publish(*snap);
+    return true;
+}
+
+// ADMISSION_METRICS_FILE (+ ADMISSION_METRICS_INTERVAL_MS) and
+// ADMISSION_METRICS_SOCKET switch the exporters on without code changes.
+void AdmissionOffice::export_metrics_from_env() {
+    const char* file = getenv("ADMISSION_METRICS_FILE");
+    if (file && *file) {
+        const char* interval = getenv("ADMISSION_METRICS_INTERVAL_MS");
+        export_metrics_to_file(file, interval ? std::max(10, atoi(interval)) : 1000);
+    }
+    const char* sock = getenv("ADMISSION_METRICS_SOCKET");
+    if (sock && *sock) export_metrics_on_socket(sock);
+}
+
+// Admitted students are also written to `csv_path` at the end of each
+// run, once hostels and mess plans are known. Empty turns the export off.
+void AdmissionOffice::set_run_export(const string& csv_path) {
+    run_export_path = csv_path;
+}
+
+// Offers the student a seat at the first university that takes them and
+// returns that university's name, or null.
+const string* AdmissionOffice::decide_seat(ApplicantStore& applicants, ApplicantHandle handle, bool eligible) {
+    Student& student = applicants[handle];
+    if (!eligible) {
+        ineligible_metric.inc();
+        run_log() << "Skipping " << student.get_name() << " - Not eligible" << endl;
+        return nullptr;
+    }
+
+    const SmallVector<ProgramId, 4>& prefs = student.get_preference_ids();
+    for (ProgramId p : prefs) {
+        if (p != UNKNOWN_PROGRAM && p >= program_seats.size()) resolve_programs();
+    }
+
+    // Bare branch preferences keep the original order: universities in the
+    // order they were added, then the branches. A ranked list is taken as
+    // written, a bare branch in it standing for every university in turn.
+    // Slots the index rules out are skipped without probing the branch.
+    seat_index.seek(student.jee_rank);
+    Category category = student.get_category_code();
+    University* admitted_to = nullptr;
+    long long skipped = 0;
+    auto try_slot = [&](uint32_t slot) {
+        if (slot == NO_SLOT) return false;
+        const SeatIndex::Slot& seat = seat_index[slot];
+        if (!seat_index.feasible(slot, category) &&
+            !(seat.university->shares_ties() && seat_index.in_window(slot) && seat.branch->at_cutoff(student))) {
+            ++skipped;
+            return false;
+        }
+        if (!seat.university->admit_student(applicants, handle, seat.branch)) return false;
+        seat_index.refresh(slot);
+        admitted_to = seat.university;
+        return true;
+    };
+    {
+        TraceSpan span("seat_allocation");
+        if (!student.has_ranked_programs()) {
+            for (size_t u = 0; u < universities.size() && !admitted_to; ++u) {
+                for (ProgramId p : prefs) {
+                    if (p != UNKNOWN_PROGRAM && try_slot(seat_index.find(u, program_seats[p].branch_id))) break;
+                }
+            }
+        } else {
+            for (ProgramId p : prefs) {
+                if (p == UNKNOWN_PROGRAM) continue;
+                const ProgramSeat& seat = program_seats[p];
+                if (!seat.any_university) {
+                    if (try_slot(seat.slot)) break;
+                    continue;
+                }
+                for (size_t u = 0; u < universities.size() && !admitted_to; ++u) {
+                    try_slot(seat_index.find(u, seat.branch_id));
+                }
+                if (admitted_to) break;
             }
         }
+    }
+    skipped_probe_metric.inc(skipped);
+    if (admitted_to) {
+        admitted_metric.inc();
+        stats.record_admission(student, admitted_to->get_name());
+        run_log() << "Admitted " << student.get_name() << " to "
+                  << admitted_to->get_name() << endl;
+        return &admitted_to->get_name();
+    }
+
+    no_seat_metric.inc();
+    run_log() << "Could not admit " << student.get_name() << " - No suitable branch/university" << endl;
+    return nullptr;
+}
 
-        if (!admitted) {
-            cout << "Could not admit " << student.get_name() << " - No suitable branch/university" << endl;
+// Rearranges who sleeps where inside each hostel; the set of occupied
+// beds stays the same. Students without a profile answer 5 throughout and
+// request no one; a request only counts when both made it.
+vector<pair<string, RoommateMatcher::Report>> AdmissionOffice::match_roommates(ApplicantStore& store,
+                                                                               const vector<RoommateProfile>& profiles,
+                                                                               uint64_t seed) {
+    TraceSpan span("roommate_matching");
+    unordered_map<int, const RoommateProfile*> by_roll;
+    for (const auto& p : profiles) by_roll[p.roll] = &p;
+
+    vector<const Hostel*> hostels;
+    for (const auto& e : boys_hostels.get_entries()) hostels.push_back(e.hostel.get());
+    for (const auto& e : girls_hostels.get_entries()) hostels.push_back(e.hostel.get());
+    for (const auto& e : shared_hostels.get_entries()) hostels.push_back(e.hostel.get());
+    vector<vector<ApplicantHandle>> housed(hostels.size());
+    for (ApplicantHandle h : store.handles()) {
+        const Student& s = store[h];
+        if (!s.has_hostel()) continue;
+        for (size_t i = 0; i < hostels.size(); ++i) {
+            if (hostels[i]->holds(s.get_hostel_bed())) {
+                housed[i].push_back(h);
+                break;
+            }
         }
     }
 
-    cout << "Application processing completed." << endl;
+    RoommateMatcher matcher(seed);
+    vector<pair<string, RoommateMatcher::Report>> reports;
+    for (size_t i = 0; i < hostels.size(); ++i) {
+        vector<ApplicantHandle>& list = housed[i];
+        if (list.empty()) continue;
+        sort(list.begin(), list.end(), [&store](ApplicantHandle a, ApplicantHandle b) {
+            return store[a].get_hostel_bed() < store[b].get_hostel_bed();
+        });
+
+        vector<uint32_t> beds(list.size());
+        vector<int> rooms;
+        unordered_map<int, uint32_t> index_of_roll;
+        uint32_t last_room = NO_BED;
+        for (uint32_t k = 0; k < list.size(); ++k) {
+            const Student& s = store[list[k]];
+            beds[k] = s.get_hostel_bed();
+            uint32_t room = hostels[i]->room_start(beds[k]);
+            if (room != last_room) rooms.push_back(0);
+            ++rooms.back();
+            last_room = room;
+            index_of_roll[s.get_roll()] = k;
+        }
+        vector<RoommateMatcher::Person> people(list.size());
+        for (uint32_t k = 0; k < list.size(); ++k) {
+            RoommateMatcher::Person& p = people[k];
+            p.traits.fill(5);
+            p.partner = RoommateMatcher::NO_PARTNER;
+            auto profile = by_roll.find(store[list[k]].get_roll());
+            if (profile == by_roll.end()) continue;
+            p.traits = profile->second->traits;
+            auto partner = index_of_roll.find(profile->second->requested_roll);
+            if (profile->second->requested_roll && partner != index_of_roll.end()) p.partner = partner->second;
+        }
+
+        RoommateMatcher::Report report;
+        vector<uint32_t> order = matcher.match(people, rooms, report);
+        for (size_t k = 0; k < order.size(); ++k) store[list[order[k]]].allocate_hostel(beds[k]);
+        reports.emplace_back(hostels[i]->get_name(), report);
+    }
+    publish_snapshot(store);
+    return reports;
 }
 
-void AdmissionOffice::show_all_admissions() const {
-    printHeader("ADMISSIONS SUMMARY");
+static MetricCounter& unhoused_metric =
+    metrics_registry().counter("admission_hostel_unhoused_total", "Admitted students left without a hostel bed");
 
-    int total_admitted = 0;
-    for (const auto & uni_ptr : universities) {
-        if (uni_ptr) {
-            total_admitted += uni_ptr->get_admitted_count();
-            uni_ptr->print_admitted();
+// Runs once admissions are decided, over the admitted students in merit
+// order: a bed from the student's gender pool or else the shared pool,
+// then a mess plan from the plan rules at the outlet with the most places
+// left, for day scholars as well as residents.
+void AdmissionOffice::allocate_facilities(ApplicantStore& store, const pmr::vector<ApplicantHandle>& admitted) {
+    {
+        TraceSpan span("hostel_allocation");
+        boys_hostels.rebuild();
+        girls_hostels.rebuild();
+        shared_hostels.rebuild();
+        bool any_hostel = !boys_hostels.get_entries().empty() || !girls_hostels.get_entries().empty() ||
+                          !shared_hostels.get_entries().empty();
+        for (ApplicantHandle h : admitted) {
+            Student& student = store[h];
+            if (!any_hostel || student.has_hostel()) continue;
+            const Hostel* hostel = student.get_gender_code() == Gender::Male
+                ? (const Hostel*)boys_hostels.place(student) : (const Hostel*)girls_hostels.place(student);
+            if (!hostel) hostel = shared_hostels.place(student);
+            if (hostel) {
+                stats.record_hostel(student, hostel->get_name());
+            } else {
+                unhoused_metric.inc();
+                run_log() << "No hostel bed left for " << student.get_name() << endl;
+            }
         }
     }
 
-    cout << "\nTOTAL STUDENTS ADMITTED: " << total_admitted << endl;
+    if (messes.empty()) return;
+    TraceSpan span("mess_allocation");
+    // One max-heap per plan over the outlets offering it, keyed by places
+    // left. Keys go stale when another plan's heap takes from a shared
+    // outlet; a popped outlet whose key no longer matches is pushed back
+    // with its current count.
+    using Slot = pair<int, int>;                    // places left, -outlet
+    array<priority_queue<Slot>, 3> open;            // MESS_PLANS order
+    for (size_t i = 0; i < messes.size(); ++i) {
+        for (int p = 0; p < (int)open.size(); ++p) {
+            if (messes[i]->offers((MessPlan)p) && messes[i]->remaining() > 0)
+                open[p].push({messes[i]->remaining(), -(int)i});
+        }
+    }
+    for (ApplicantHandle h : admitted) {
+        Student& student = store[h];
+        if (student.has_mess()) continue;
+        int plan = plan_rules.decide(student);
+        if (plan == NO_MESS_PLAN) continue;
+        auto& heap = open[plan];
+        int outlet = -1;
+        while (!heap.empty() && outlet < 0) {
+            Slot top = heap.top();
+            heap.pop();
+            int left = messes[-top.second]->remaining();
+            if (left == 0) continue;
+            if (left != top.first) heap.push({left, top.second});
+            else outlet = -top.second;
+        }
+        if (outlet < 0) {
+            mess_rejected_metric.inc();
+            run_log() << "No " << mess_plan_name((MessPlan)plan) << " mess place left for "
+                      << student.get_name() << endl;
+            continue;
+        }
+        Mess& m = *messes[outlet];
+        if (m.allocate_mess(student, (MessPlan)plan)) stats.record_mess(student, mess_plan_name((MessPlan)plan));
+        if (m.remaining() > 0) heap.push({m.remaining(), -outlet});
+    }
 }
 
-void AdmissionOffice::show_detailed_report() const {
-    printHeader("DETAILED ADMISSION REPORT");
+namespace {
+
+struct RunItem {
+    ApplicantHandle handle = NO_APPLICANT;
+    const string* university = nullptr;     // null unless admitted
+    pmr::string log;
+
+    RunItem() = default;
+    explicit RunItem(pmr::memory_resource* logs) : log(logs) { }
+};
+
+// Collects one student's log lines; take() hands them over without a copy.
+class RunLogBuffer : public streambuf {
+private:
+    pmr::string text;
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) text.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    streamsize xsputn(const char* s, streamsize n) override {
+        text.append(s, (size_t)n);
+        return n;
+    }
+
+public:
+    explicit RunLogBuffer(pmr::memory_resource* logs) : text(logs) { }
+    pmr::string take() {
+        pmr::string out(text.get_allocator());
+        out.swap(text);
+        return out;
+    }
+};
+
+const size_t RUN_SCRATCH_BLOCK = 4 * 1024;      // first block; later ones grow geometrically
+
+const size_t RUN_QUEUE_DEPTH = 1024;
+
+void write_export_header(ostream& csv) {
+    csv << "Roll,Name,JEE_Rank,University,Branch,Category,Hostel,Mess_Plan\n";
+}
 
-    for (const auto & uni_ptr : universities) {
-        if (uni_ptr) {
-            uni_ptr->print_branch_status();
+void write_export_row(ostream& csv, const Student& s, const string& university) {
+    csv << s.get_roll() << ",\"" << s.get_name() << "\"," << s.jee_rank << ",\""
+        << university << "\",\"" << s.get_assigned_branch() << "\","
+        << s.get_category() << ',' << (s.has_hostel() ? "Yes" : "No") << ','
+        << (s.has_mess() ? s.get_mess_plan() : "No") << '\n';
+}
+
+}
+
+// The run is a pipeline of stages joined by bounded queues:
+//
+//   validate -> merit bucketing   (overlap; merit order needs every applicant)
+//   seat allocation -> output (log)
+//
+// then one hostel/mess pass over everyone admitted and the export. The
+// allocation loop logs into a buffer and the log travels with the student,
+// so the console sees exactly the sequential order.
+//
+// Working buffers come from `scratch`, dropped in one step when the run
+// returns. Log strings are recycled through `logs` once printed, since
+// the output stage frees them on another thread. The merit order is kept
+// by the store after the run and is allocated normally.
+void AdmissionOffice::process_applications(ApplicantStore& applicants) {
+    TraceSpan run_span("process_applications");
+    MemoryScope mem(MEM_SEAT_STATE);
+    auto run_start = chrono::steady_clock::now();
+    run_active_metric.set(1);
+    reset_seat_index();
+
+    pmr::monotonic_buffer_resource scratch(RUN_SCRATCH_BLOCK);
+    pmr::synchronized_pool_resource logs(&scratch);
+    pmr::vector<char> eligible(applicants.size(), 0, &scratch);
+    {
+        TraceSpan span("merit_sort");
+        BoundedQueue<ApplicantHandle> validated(RUN_QUEUE_DEPTH);
+        stats.begin_run(applicants.get_generation());
+        thread validate([&]() {
+            TraceSpan stage("validate");
+            for (ApplicantHandle h : applicants.handles()) {
+                const Student& s = applicants[h];
+                eligible[h] = s.is_eligible();
+                stats.record_applicant(s);
+                validated.push(h);
+            }
+            validated.close();
+        });
+
+        // Power-of-two rank buckets keep arrival order; a stable sort
+        // inside each bucket then gives the same order as one stable sort.
+        pmr::vector<pmr::vector<ApplicantHandle>> buckets(AdmissionStats::RANK_BUCKETS, &scratch);
+        ApplicantHandle h;
+        while (validated.pop(h)) {
+            buckets[AdmissionStats::rank_bucket(applicants[h].jee_rank)].push_back(h);
+        }
+        validate.join();
+
+        vector<ApplicantHandle> merit;
+        merit.reserve(applicants.size());
+        for (auto& bucket : buckets) {
+            stable_sort(bucket.begin(), bucket.end(), [&applicants](ApplicantHandle a, ApplicantHandle b) {
+                return applicants[a].jee_rank < applicants[b].jee_rank;
+            });
+            merit.insert(merit.end(), bucket.begin(), bucket.end());
         }
+        applicants.set_order(std::move(merit));
     }
 
-    printSection("HOSTEL STATUS");
-    if (boys_hostel) boys_hostel->print_status();
-    if (girls_hostel) girls_hostel->print_status();
+    cout << "\nProcessing " << applicants.size() << " applications..." << endl;
+    publish_snapshot(applicants);
 
-    if (mess) {
-        printSection("MESS STATUS");
-        mess->print_status();
+    BoundedQueue<RunItem> decided(RUN_QUEUE_DEPTH);
+    pmr::vector<ApplicantHandle> admitted(&scratch);
+    pmr::vector<const string*> admitted_to(&scratch);
+
+    thread output([&]() {
+        TraceSpan stage("run_output");
+        MemoryScope stage_mem(MEM_REPORTS);
+        RunItem item(&logs);
+        while (decided.pop(item)) cout << item.log;
+        cout.flush();
+    });
+
+    {
+        TraceSpan loop_span("allocation_loop");
+        RunLogBuffer log_text(&logs);
+        ostream buffer(&log_text);
+        RunLogScope log(buffer);
+        size_t processed = 0;
+        for (ApplicantHandle handle : applicants.handles()) {
+            if (snapshot_interval && processed > 0 && processed % snapshot_interval == 0) {
+                publish_snapshot(applicants);
+            }
+            ++processed;
+            processed_metric.inc();
+            auto decision_start = chrono::steady_clock::now();
+            RunItem item(&logs);
+            item.handle = handle;
+
+            item.university = decide_seat(applicants, handle, eligible[handle]);
+            if (item.university) {
+                admitted.push_back(handle);
+                admitted_to.push_back(item.university);
+            }
+            item.log = log_text.take();
+            decided.push(std::move(item));
+            decision_latency_metric.record(chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - decision_start).count());
+        }
+        decided.close();
+    }
+    output.join();
+
+    allocate_facilities(applicants, admitted);
+    if (!run_export_path.empty()) {
+        TraceSpan span("run_export");
+        ofstream csv(run_export_path);
+        if (csv) write_export_header(csv);
+        for (size_t i = 0; csv && i < admitted.size(); ++i) {
+            write_export_row(csv, applicants[admitted[i]], *admitted_to[i]);
+        }
+    }
+
+    {
+        TraceSpan span("publish_snapshot");
+        publish_snapshot(applicants);
+    }
+    run_duration_metric.record(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - run_start).count());
+    run_active_metric.set(0);
+    cout << "Application processing completed." << endl;
+}
+
+// Streams a merit-ordered population through the allocator without
+// holding it in memory. Each applicant is materialised, decided and
+// dropped again unless admitted, so only seat state and the admitted
+// roster (bounded by the seat count) stay resident. `admitted` receives
+// the admitted students; it must not be reordered while the run is in
+// progress. Rolls follow input order.
+void AdmissionOffice::process_out_of_core(ExternalMeritSorter& merit, ApplicantStore& admitted) {
+    TraceSpan run_span("process_out_of_core");
+    MemoryScope mem(MEM_SEAT_STATE);
+    auto run_start = chrono::steady_clock::now();
+    run_active_metric.set(1);
+    reset_seat_index();
+
+    {
+        TraceSpan span("merit_merge");
+        merit.finish();
+    }
+    int first_roll = RollAllocator::reserve((int)merit.total());
+    cout << "\nProcessing " << merit.total() << " applications out of core ("
+         << merit.spilled_runs() << " sorted runs)..." << endl;
+    stats.begin_run(admitted.get_generation());
+    publish_snapshot(admitted);
+
+    TraceSpan loop_span("allocation_loop");
+    pmr::monotonic_buffer_resource scratch(RUN_SCRATCH_BLOCK);     // dropped when the run returns
+    pmr::vector<ApplicantHandle> admitted_now(&scratch);
+    pmr::vector<const string*> admitted_to(&scratch);
+    // Each candidate's long preference list spills into this scratch
+    // buffer rather than the run arena; it is reset after every record and
+    // only admitted students copy their list out.
+    vector<char> spill_buffer(64 * 1024);
+    pmr::monotonic_buffer_resource spill_scratch(spill_buffer.data(), spill_buffer.size(), pmr::new_delete_resource());
+    ApplicantRecord rec;
+    uint64_t seq = 0;
+    size_t processed = 0;
+    while (merit.next(rec, seq)) {
+        if (snapshot_interval && processed > 0 && processed % snapshot_interval == 0) {
+            publish_snapshot(admitted);
+        }
+        ++processed;
+        processed_metric.inc();
+        auto decision_start = chrono::steady_clock::now();
+
+        StringPool::Mark mark = applicant_strings().mark();
+        ApplicantHandle handle;
+        {
+            MemoryScope applicant_mem(MEM_APPLICANTS);
+            SpillScope spill(spill_scratch);
+            handle = admitted.emplace_back(rec.make());
+        }
+        Student& student = admitted[handle];
+        student.assign_roll(first_roll + (int)seq);
+        stats.record_applicant(student);
+
+        const string* university = decide_seat(admitted, handle, student.is_eligible());
+        if (university) {
+            MemoryScope applicant_mem(MEM_APPLICANTS);
+            if (!student.get_preference_ids().is_inline()) student = Student(student);     // list into the run arena
+            admitted_now.push_back(handle);
+            admitted_to.push_back(university);
+        } else {
+            admitted.pop_back();
+            applicant_strings().rewind(mark);
+        }
+        spill_scratch.release();
+        decision_latency_metric.record(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - decision_start).count());
+    }
+
+    allocate_facilities(admitted, admitted_now);
+    if (!run_export_path.empty()) {
+        TraceSpan span("run_export");
+        ofstream csv(run_export_path);
+        if (csv) write_export_header(csv);
+        for (size_t i = 0; csv && i < admitted_now.size(); ++i) {
+            write_export_row(csv, admitted[admitted_now[i]], *admitted_to[i]);
+        }
     }
+
+    {
+        TraceSpan span("publish_snapshot");
+        publish_snapshot(admitted);
+    }
+    run_duration_metric.record(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - run_start).count());
+    run_active_metric.set(0);
+    cout << "Application processing completed." << endl;
+}
+
+void AdmissionOffice::show_all_admissions() const {
+    TraceSpan span("show_all_admissions", "report");
+    MemoryScope mem(MEM_REPORTS);
+    snapshot()->print_all_admissions();
+}
+
+void AdmissionOffice::show_detailed_report() const {
+    TraceSpan span("show_detailed_report", "report");
+    MemoryScope mem(MEM_REPORTS);
+    snapshot()->print_detailed_report();
 }
 
-void AdmissionOffice::show_eligibility_report(const vector<Student>& applicants) const {
+void AdmissionOffice::show_eligibility_report(const ApplicantStore& applicants) const {
+    TraceSpan span("show_eligibility_report", "report");
+    MemoryScope mem(MEM_REPORTS);
     printHeader("ELIGIBILITY REPORT");
 
     cout << "+-------+----------------------+--------+--------+------+--------+----------+-------------------+" << endl;
@@ -560,8 +4585,639 @@ void AdmissionOffice::show_eligibility_report(const vector<Student>& applicants)
     cout << "+-------+----------------------+--------+--------+------+--------+----------+-------------------+" << endl;
 }
 
+// The two sample universities and default hostels/mess used by the
+// non-interactive tools.
+void setup_default_campus(AdmissionOffice& office) {
+    office.load_campus(default_campus());
+}
+
 const vector<unique_ptr<University>>& AdmissionOffice::get_universities() const {
     return universities;
 }
 
 AdmissionOffice::~AdmissionOffice() = default;
+
+void WireWriter::str(string_view v) {
+    v = v.substr(0, 255);
+    u8((uint8_t)v.size());
+    buf.append(v.data(), v.size());
+}
+
+WireReader::WireReader(const string& payload) :
+    pos(payload.data()),
+    end(payload.data() + payload.size()),
+    ok(true)
+{ }
+
+bool WireReader::take(void* out, size_t n) {
+    if (!ok || (size_t)(end - pos) < n) {
+        ok = false;
+        memset(out, 0, n);
+        return false;
+    }
+    memcpy(out, pos, n);
+    pos += n;
+    return true;
+}
+
+uint8_t WireReader::u8() { uint8_t v; take(&v, sizeof v); return v; }
+int32_t WireReader::i32() { int32_t v; take(&v, sizeof v); return v; }
+int64_t WireReader::i64() { int64_t v; take(&v, sizeof v); return v; }
+
+string WireReader::str() {
+    uint8_t n = u8();
+    if (!ok || (size_t)(end - pos) < n) {
+        ok = false;
+        return string();
+    }
+    string v(pos, n);
+    pos += n;
+    return v;
+}
+
+static bool write_all(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t w = send(fd, data, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        data += w;
+        n -= w;
+    }
+    return true;
+}
+
+static bool read_all(int fd, char* data, size_t n) {
+    while (n > 0) {
+        ssize_t r = recv(fd, data, n, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        data += r;
+        n -= r;
+    }
+    return true;
+}
+
+bool wire_send(int fd, uint8_t code, const string& payload) {
+    if (payload.size() > WIRE_MAX_PAYLOAD) return false;
+    char head[5];
+    uint32_t len = (uint32_t)payload.size();
+    memcpy(head, &len, 4);
+    head[4] = (char)code;
+    if (payload.empty()) return write_all(fd, head, sizeof head);
+    string frame(head, sizeof head);
+    frame += payload;
+    return write_all(fd, frame.data(), frame.size());
+}
+
+bool wire_recv(int fd, uint8_t& code, string& payload) {
+    char head[5];
+    if (!read_all(fd, head, sizeof head)) return false;
+    uint32_t len;
+    memcpy(&len, head, 4);
+    if (len > WIRE_MAX_PAYLOAD) return false;
+    code = (uint8_t)head[4];
+    payload.resize(len);
+    return len == 0 || read_all(fd, &payload[0], len);
+}
+
+void ApplicantRecord::encode(WireWriter& w) const {
+    w.str(name);
+    w.i32(income);
+    w.i32(jee_rank);
+    w.u8((uint8_t)std::min<size_t>(preferences.size(), 255));
+    for (size_t i = 0; i < preferences.size() && i < 255; ++i) w.str(preferences[i]);
+    w.str(contact);
+    w.i32(percentage_12th);
+    w.i32(age);
+    w.str(gender);
+    w.str(category);
+}
+
+bool ApplicantRecord::decode(WireReader& r) {
+    name = r.str();
+    income = r.i32();
+    jee_rank = r.i32();
+    preferences.resize(r.u8());
+    for (auto& p : preferences) p = r.str();
+    contact = r.str();
+    percentage_12th = r.i32();
+    age = r.i32();
+    gender = r.str();
+    category = r.str();
+    return r.good();
+}
+
+// name,income,jee_rank,preferences,contact,percentage_12th,age,gender,category
+// optionally followed by score,maths,physics. Preferences are ';'-separated;
+// fields may be double-quoted.
+bool ApplicantRecord::parse_csv(const string& line) {
+    vector<string> fields;
+    string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') { field += '"'; ++i; }
+            else if (c == '"') quoted = false;
+            else field += c;
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(std::move(field));
+    if (fields.size() != 9 && fields.size() != 12) return false;
+
+    char* end = nullptr;
+    auto number = [&end](const string& f, int& out) {
+        long v = strtol(f.c_str(), &end, 10);
+        out = (int)v;
+        return !f.empty() && *end == '\0';
+    };
+    name = fields[0];
+    contact = fields[4];
+    gender = fields[7];
+    category = fields[8];
+    preferences.clear();
+    istringstream prefs(fields[3]);
+    string pref;
+    while (getline(prefs, pref, ';')) {
+        if (!pref.empty()) preferences.push_back(pref);
+    }
+    has_score = fields.size() == 12;
+    if (has_score && !(number(fields[9], score) && number(fields[10], maths) && number(fields[11], physics))) {
+        return false;
+    }
+    return number(fields[1], income) && number(fields[2], jee_rank) &&
+           number(fields[5], percentage_12th) && number(fields[6], age);
+}
+
+Student ApplicantRecord::make(int roll) const {
+    return Student(name, income, jee_rank, preferences, contact, percentage_12th, age, gender, category, roll);
+}
+
+MeritListBuilder::MeritListBuilder(uint64_t lottery_seed, unsigned threads_) :
+    seed(lottery_seed),
+    threads(threads_ ? threads_ : std::max(1u, thread::hardware_concurrency()))
+{ }
+
+static uint64_t clamp_field(long long v, long long lo, long long hi) {
+    return (uint64_t)(std::max(lo, std::min(hi, v)) - lo);
+}
+
+uint64_t MeritListBuilder::pack_key(const ScoreRecord& r) const {
+    // splitmix64 of (seed, id): a fixed, seed-dependent shuffle of equals
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull * ((uint64_t)r.id + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+
+    uint64_t key = 0xFFFF - clamp_field(r.score, -SCORE_OFFSET, SCORE_OFFSET - 1);
+    key = (key << 10) | (0x3FF - clamp_field(r.maths, -MARKS_OFFSET, MARKS_OFFSET - 1));
+    key = (key << 10) | (0x3FF - clamp_field(r.physics, -MARKS_OFFSET, MARKS_OFFSET - 1));
+    key = (key << 7) | (0x7F - clamp_field(r.percentage_12th, 0, 127));
+    key = (key << 7) | (0x7F - clamp_field(r.age, 0, 127));
+    key = (key << 14) | (z & 0x3FFF);
+    return key;
+}
+
+vector<MeritRank> MeritListBuilder::build(const vector<ScoreRecord>& records) const {
+    TraceSpan span("merit_list");
+    struct Keyed {
+        uint64_t key;
+        uint32_t id;
+        uint32_t index;
+        bool operator<(const Keyed& o) const { return key != o.key ? key < o.key : id < o.id; }
+    };
+    static_assert(sizeof(ScoreRecord) + sizeof(Keyed) + sizeof(MeritRank) == BYTES_PER_RECORD,
+                  "BYTES_PER_RECORD is out of date");
+
+    size_t n = records.size();
+    vector<Keyed> keyed(n);
+    unsigned workers = (unsigned)std::max<size_t>(1, std::min<size_t>(threads, n / 65536));
+    size_t chunk = (n + workers - 1) / max(1u, workers);
+
+    // Pack and sort one chunk per worker...
+    vector<thread> pool;
+    for (unsigned t = 0; t < workers; ++t) {
+        pool.emplace_back([&, t]() {
+            size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+            for (size_t i = begin; i < end; ++i) {
+                keyed[i] = Keyed{pack_key(records[i]), records[i].id, (uint32_t)i};
+            }
+            sort(keyed.begin() + begin, keyed.begin() + end);
+        });
+    }
+    for (auto& th : pool) th.join();
+
+    // ...then merge neighbouring sorted ranges, each level in parallel.
+    for (size_t width = chunk; width < n; width *= 2) {
+        pool.clear();
+        for (size_t begin = 0; begin + width < n; begin += 2 * width) {
+            size_t mid = begin + width, end = std::min(n, begin + 2 * width);
+            pool.emplace_back([&keyed, begin, mid, end]() {
+                inplace_merge(keyed.begin() + begin, keyed.begin() + mid, keyed.begin() + end);
+            });
+        }
+        for (auto& th : pool) th.join();
+    }
+
+    vector<MeritRank> ranks(n);
+    vector<int> category_next(CATEGORIES.size(), 0);
+    for (size_t i = 0; i < n; ++i) {
+        const ScoreRecord& r = records[keyed[i].index];
+        ranks[i] = MeritRank{r.id, (int)i + 1, ++category_next[(int)r.category]};
+    }
+    return ranks;
+}
+
+// Writes each common rank into the student the id refers to, as a handle.
+void MeritListBuilder::apply(const vector<MeritRank>& ranks, ApplicantStore& applicants) {
+    for (const MeritRank& r : ranks) {
+        if (applicants.contains(r.id)) applicants[r.id].jee_rank = r.common_rank;
+    }
+}
+
+ExternalMeritSorter::ExternalMeritSorter(size_t budget_bytes, string tmp_dir) :
+    budget(std::max<size_t>(budget_bytes, 1 << 20)),
+    dir(std::move(tmp_dir)),
+    pending(),
+    pending_bytes(0),
+    next_seq(0),
+    spills(0),
+    next_run(0),
+    pending_pos(0),
+    finished(false)
+{ }
+
+void ExternalMeritSorter::add(const ApplicantRecord& rec) {
+    MemoryScope mem(MEM_APPLICANTS);
+    WireWriter w;
+    rec.encode(w);
+    pending.push_back(Entry{rec.jee_rank, next_seq++, w.data()});
+    pending_bytes += sizeof(Entry) + pending.back().frame.capacity();
+    if (pending_bytes >= budget) spill();
+}
+
+// Sorts the buffered records and writes them out as one run.
+void ExternalMeritSorter::spill() {
+    if (pending.empty()) return;
+    TraceSpan span("merit_spill");
+    sort(pending.begin(), pending.end(), [](const Entry& a, const Entry& b) {
+        return a.rank != b.rank ? a.rank < b.rank : a.seq < b.seq;
+    });
+
+    string path = new_run_path();
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) throw runtime_error("cannot create merit run " + path);
+    run_paths.push_back(path);
+    ++spills;
+    for (const Entry& e : pending) write_entry(out, e);
+    if (!out) throw runtime_error("short write to merit run " + path);
+    pending.clear();
+    pending.shrink_to_fit();
+    pending_bytes = 0;
+}
+
+string ExternalMeritSorter::new_run_path() {
+    return dir + "/admission-run-" + to_string(getpid()) + "-" +
+           to_string((uintptr_t)this) + "-" + to_string(next_run++) + ".bin";
+}
+
+// [rank:i32][seq:u64][length:u32][frame] per record.
+void ExternalMeritSorter::write_entry(ostream& out, const Entry& e) {
+    uint32_t len = (uint32_t)e.frame.size();
+    out.write((const char*)&e.rank, sizeof e.rank);
+    out.write((const char*)&e.seq, sizeof e.seq);
+    out.write((const char*)&len, sizeof len);
+    out.write(e.frame.data(), len);
+}
+
+unique_ptr<ExternalMeritSorter::RunReader> ExternalMeritSorter::open_run(const string& path, size_t buffer_size) {
+    auto r = make_unique<RunReader>();
+    r->buffer.resize(buffer_size);
+    r->in.rdbuf()->pubsetbuf(r->buffer.data(), r->buffer.size());
+    r->in.open(path, ios::binary);
+    if (!r->in) throw runtime_error("cannot reopen merit run " + path);
+    read_entry(*r);
+    return r;
+}
+
+bool ExternalMeritSorter::read_entry(RunReader& r) {
+    uint32_t len = 0;
+    r.has_head = r.in.read((char*)&r.head.rank, sizeof r.head.rank) &&
+                 r.in.read((char*)&r.head.seq, sizeof r.head.seq) &&
+                 r.in.read((char*)&len, sizeof len);
+    if (!r.has_head) return false;
+    r.head.frame.resize(len);
+    r.has_head = (bool)r.in.read(&r.head.frame[0], len);
+    return r.has_head;
+}
+
+// Merges run_paths[first, first + count) into one new run appended to
+// run_paths and deletes the inputs. Each input and the output get one
+// MERGE_BUFFER.
+void ExternalMeritSorter::merge_runs(size_t first, size_t count) {
+    TraceSpan span("merit_merge_pass");
+    vector<unique_ptr<RunReader>> inputs;
+    priority_queue<HeapItem, vector<HeapItem>, greater<HeapItem>> merge_heap;
+    for (size_t i = 0; i < count; ++i) {
+        inputs.push_back(open_run(run_paths[first + i], MERGE_BUFFER));
+        if (inputs.back()->has_head) merge_heap.push(HeapItem{inputs.back()->head.rank, inputs.back()->head.seq, i});
+    }
+
+    string path = new_run_path();
+    vector<char> out_buffer(MERGE_BUFFER);
+    ofstream out;
+    out.rdbuf()->pubsetbuf(out_buffer.data(), out_buffer.size());
+    out.open(path, ios::binary | ios::trunc);
+    if (!out) throw runtime_error("cannot create merit run " + path);
+    run_paths.push_back(path);
+    while (!merge_heap.empty()) {
+        HeapItem top = merge_heap.top();
+        merge_heap.pop();
+        RunReader& r = *inputs[top.run];
+        write_entry(out, r.head);
+        if (read_entry(r)) merge_heap.push(HeapItem{r.head.rank, r.head.seq, top.run});
+    }
+    out.close();
+    if (!out) throw runtime_error("short write to merit run " + path);
+    inputs.clear();
+    for (size_t i = 0; i < count; ++i) unlink(run_paths[first + i].c_str());
+}
+
+// Everything fits in the budget: sort in place and serve from memory.
+// Otherwise spill the tail, merge in passes until every remaining run
+// can have its own MERGE_BUFFER, then open them behind read buffers that
+// share the budget, seeding the merge heap with each run's first record.
+void ExternalMeritSorter::finish() {
+    if (finished) return;
+    finished = true;
+    if (run_paths.empty()) {
+        sort(pending.begin(), pending.end(), [](const Entry& a, const Entry& b) {
+            return a.rank != b.rank ? a.rank < b.rank : a.seq < b.seq;
+        });
+        return;
+    }
+    spill();
+
+    MemoryScope mem(MEM_APPLICANTS);
+    size_t fan_in = std::max<size_t>(2, budget / MERGE_BUFFER - 1);     // one buffer left for the output
+    while (run_paths.size() > fan_in) {
+        size_t count = run_paths.size();
+        for (size_t i = 0; i < count; i += fan_in) {
+            size_t group = std::min(fan_in, count - i);
+            if (group == 1) run_paths.push_back(run_paths[i]);
+            else merge_runs(i, group);
+        }
+        run_paths.erase(run_paths.begin(), run_paths.begin() + count);
+    }
+
+    size_t buffer_size = std::min<size_t>(1 << 20, std::max((size_t)MERGE_BUFFER, budget / run_paths.size()));
+    for (const string& path : run_paths) {
+        runs.push_back(open_run(path, buffer_size));
+        if (runs.back()->has_head) heap.push(HeapItem{runs.back()->head.rank, runs.back()->head.seq, runs.size() - 1});
+    }
+}
+
+bool ExternalMeritSorter::next(ApplicantRecord& out, uint64_t& seq) {
+    finish();
+    if (runs.empty()) {
+        if (pending_pos == pending.size()) return false;
+        const Entry& e = pending[pending_pos++];
+        WireReader in(e.frame);
+        seq = e.seq;
+        return out.decode(in);
+    }
+
+    if (heap.empty()) return false;
+    HeapItem top = heap.top();
+    heap.pop();
+    RunReader& r = *runs[top.run];
+    WireReader in(r.head.frame);
+    seq = r.head.seq;
+    bool ok = out.decode(in);
+    if (read_entry(r)) heap.push(HeapItem{r.head.rank, r.head.seq, top.run});
+    return ok;
+}
+
+ExternalMeritSorter::~ExternalMeritSorter() {
+    runs.clear();
+    for (const string& path : run_paths) unlink(path.c_str());
+}
+
+AdmissionDaemon::AdmissionDaemon(AdmissionOffice& office_, string path_) :
+    office(office_),
+    path(std::move(path_)),
+    listen_fd(-1),
+    running(false),
+    unpublished(false)
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return;
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) return;
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        return;
+    }
+
+    office.publish_snapshot(applicants);
+    running = true;
+    writer = thread([this]() { writer_loop(); });
+    acceptor = thread([this]() { accept_loop(); });
+}
+
+bool AdmissionDaemon::is_listening() const { return listen_fd >= 0; }
+
+void AdmissionDaemon::accept_loop() {
+    while (running) {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        lock_guard<mutex> guard(clients_lock);
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (!it->finished) { ++it; continue; }
+            it->worker.join();
+            close(it->fd);
+            it = clients.erase(it);
+        }
+        clients.emplace_back();
+        Client& c = clients.back();
+        c.fd = fd;
+        c.worker = thread([this, &c]() {
+            serve(c.fd);
+            c.finished = true;
+        });
+    }
+}
+
+void AdmissionDaemon::serve(int fd) {
+    uint8_t op;
+    string payload;
+    while (running && wire_recv(fd, op, payload)) {
+        if (!handle(fd, op, payload)) break;
+    }
+    shutdown(fd, SHUT_RDWR);
+}
+
+// Returns false once the connection should be dropped.
+bool AdmissionDaemon::handle(int fd, uint8_t op, const string& payload) {
+    WireReader in(payload);
+    WireWriter out;
+
+    switch ((WireOp)op) {
+    case WireOp::Submit: {
+        ApplicantRecord rec;
+        if (!rec.decode(in)) return wire_send(fd, (uint8_t)WireStatus::BadRequest, "");
+        long long roll = enqueue(Job::Submit, std::move(rec));
+        if (roll < 0) return wire_send(fd, (uint8_t)WireStatus::Unavailable, "");
+        out.i32((int32_t)roll);
+        return wire_send(fd, (uint8_t)WireStatus::Ok, out.data());
+    }
+    case WireOp::RunRound: {
+        long long admitted = enqueue(Job::Round);
+        if (admitted < 0) return wire_send(fd, (uint8_t)WireStatus::Unavailable, "");
+        out.i64(admitted);
+        out.i64((int64_t)office.snapshot()->epoch);
+        return wire_send(fd, (uint8_t)WireStatus::Ok, out.data());
+    }
+    case WireOp::Status: {
+        int roll = in.i32();
+        if (!in.good()) return wire_send(fd, (uint8_t)WireStatus::BadRequest, "");
+        if (!sync()) return wire_send(fd, (uint8_t)WireStatus::Unavailable, "");
+        auto snap = office.snapshot();
+        const StudentView* v = snap->find_student(roll);
+        if (!v) return wire_send(fd, (uint8_t)WireStatus::NotFound, "");
+        out.i64((int64_t)snap->epoch);
+        out.i32(v->roll);
+        out.str(v->name);
+        out.i32(v->jee_rank);
+        out.u8(v->eligible);
+        out.u8(v->admitted);
+        out.str(v->university);
+        out.str(v->branch);
+        out.u8(v->hostel);
+        out.u8(v->mess);
+        out.str(v->mess_plan);
+        out.str(v->room);
+        out.str(v->mess_outlet);
+        return wire_send(fd, (uint8_t)WireStatus::Ok, out.data());
+    }
+    case WireOp::Summary: {
+        if (!sync()) return wire_send(fd, (uint8_t)WireStatus::Unavailable, "");
+        auto snap = office.snapshot();
+        out.i64((int64_t)snap->epoch);
+        out.i64((int64_t)snap->students->size());
+        out.i64((int64_t)snap->stats.eligible);
+        out.i64((int64_t)snap->stats.admitted);
+        out.i64((int64_t)snap->stats.hostel_allocated);
+        out.i64((int64_t)snap->stats.mess_allocated);
+        return wire_send(fd, (uint8_t)WireStatus::Ok, out.data());
+    }
+    }
+    wire_send(fd, (uint8_t)WireStatus::BadRequest, "");
+    return false;
+}
+
+long long AdmissionDaemon::enqueue(Job::Kind kind, ApplicantRecord applicant) {
+    future<long long> result;
+    {
+        lock_guard<mutex> guard(queue_lock);
+        if (!running) return -1;
+        queue.push_back(Job{kind, std::move(applicant), promise<long long>()});
+        result = queue.back().done.get_future();
+    }
+    queue_ready.notify_one();
+    return result.get();
+}
+
+// Makes sure every answered Submit is in the current snapshot. False if
+// the daemon is shutting down.
+bool AdmissionDaemon::sync() {
+    if (!unpublished.load(memory_order_acquire)) return true;
+    return enqueue(Job::Publish) >= 0;
+}
+
+void AdmissionDaemon::writer_loop() {
+    deque<Job> batch;
+    vector<Job*> waiting;
+    chrono::steady_clock::time_point publish_due;   // of the oldest unpublished submission
+    auto publish = [this]() {
+        office.publish_snapshot(applicants);
+        unpublished.store(false, memory_order_release);
+    };
+    while (true) {
+        {
+            unique_lock<mutex> guard(queue_lock);
+            auto ready = [this]() { return !queue.empty() || !running; };
+            if (unpublished) queue_ready.wait_until(guard, publish_due, ready);
+            else queue_ready.wait(guard, ready);
+            if (queue.empty() && !running) break;
+            batch.swap(queue);
+        }
+
+        // Submissions are appended in arrival order; a round runs over
+        // everything that arrived before it in the batch.
+        for (auto& job : batch) {
+            switch (job.kind) {
+            case Job::Submit: {
+                MemoryScope mem(MEM_APPLICANTS);
+                ApplicantHandle h = applicants.emplace_back(job.applicant.make());
+                if (!unpublished) publish_due = chrono::steady_clock::now() + chrono::milliseconds(PUBLISH_DELAY_MS);
+                unpublished.store(true, memory_order_release);
+                job.done.set_value(applicants[h].get_roll());
+                break;
+            }
+            case Job::Round:
+                office.process_applications(applicants);
+                unpublished.store(false, memory_order_release);
+                job.done.set_value(University::total_admitted());
+                break;
+            case Job::Publish:
+                waiting.push_back(&job);
+                break;
+            }
+        }
+        if (unpublished && (!waiting.empty() || chrono::steady_clock::now() >= publish_due)) publish();
+        for (Job* job : waiting) job->done.set_value(0);
+        waiting.clear();
+        batch.clear();
+    }
+}
+
+void AdmissionDaemon::stop() {
+    {
+        lock_guard<mutex> guard(queue_lock);
+        if (!running) return;
+        running = false;
+    }
+    queue_ready.notify_all();
+    if (acceptor.joinable()) acceptor.join();
+    if (writer.joinable()) writer.join();
+
+    lock_guard<mutex> guard(clients_lock);
+    for (auto& c : clients) shutdown(c.fd, SHUT_RDWR);
+    for (auto& c : clients) {
+        if (c.worker.joinable()) c.worker.join();
+        close(c.fd);
+    }
+    clients.clear();
+}
+
+AdmissionDaemon::~AdmissionDaemon() {
+    stop();
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(path.c_str());
+    }
+}
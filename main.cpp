@@ -28,21 +28,6 @@ static vector<string> split_preferences(const string &line) {
     return out;
 }
 
-struct BranchInfo {
-    string name;
-    int general;
-    unordered_map<string,int> reserved;
-    int opening_rank;
-    int closing_rank;
-};
-
-struct UnivInfo {
-    string name;
-    int opening_rank;
-    int closing_rank;
-    vector<BranchInfo> branches;
-};
-
 static void print_reserved_map(const unordered_map<string,int>& m) {
     cout << "| ";
     for (auto &cat : CATEGORIES) {
@@ -54,6 +39,15 @@ static void print_reserved_map(const unordered_map<string,int>& m) {
     }
 }
 
+static void print_reserved_map(const array<int, CATEGORY_COUNT>& seats) {
+    cout << "| ";
+    for (int c = 0; c < CATEGORY_COUNT; ++c) {
+        if (seats[c] > 0) {
+            cout << CATEGORIES[c] << ": " << seats[c] << "  ";
+        }
+    }
+}
+
 void displayWelcomeMessage() {
     cout << "\n" << string(70, '=') << endl;
     cout << "    UNIVERSITY ADMISSION MANAGEMENT SYSTEM" << endl;
@@ -91,12 +85,13 @@ void printWarning(const string& message) {
     cout << "[WARNING] " << message << endl;
 }
 
-int main() {
+// main [campus.conf] -- a campus config replaces the interactive setup.
+int main(int argc, char** argv) {
     displayWelcomeMessage();
 
     AdmissionOffice office;
-    vector<Student> applicants;
-    vector<UnivInfo> created_univs;
+    office.export_metrics_from_env();
+    ApplicantStore applicants;
 
     printMenuHeader("SYSTEM SETUP");
 
@@ -144,57 +139,42 @@ int main() {
 
     printSuccess("Campus facilities initialized successfully!");
 
-    auto create_sample_universities = [&]() {
-        printInfo("Creating sample universities...");
-
-        {
-            auto uni1 = make_unique<University>("TechVille Institute of Technology", 1, 50000);
-
-            unordered_map<string,int> cse_reserved = { {"OBC",5}, {"SC",3}, {"ST",2}, {"EWS",2} };
-            uni1->add_branch(make_unique<Branch>("Computer Science", 15, cse_reserved, 1, 5000));
-
-            unordered_map<string,int> ece_reserved = { {"OBC",4}, {"SC",2}, {"EWS",2} };
-            uni1->add_branch(make_unique<Branch>("Electronics", 12, ece_reserved, 1, 8000));
-
-            unordered_map<string,int> mech_reserved = { {"OBC",3}, {"SC",2}, {"ST",1} };
-            uni1->add_branch(make_unique<Branch>("Mechanical", 10, mech_reserved, 1, 15000));
-
-            UnivInfo u1;
-            u1.name = "TechVille Institute of Technology";
-            u1.opening_rank = 1;
-            u1.closing_rank = 50000;
-            u1.branches.push_back({"Computer Science", 15, cse_reserved, 1, 5000});
-            u1.branches.push_back({"Electronics", 12, ece_reserved, 1, 8000});
-            u1.branches.push_back({"Mechanical", 10, mech_reserved, 1, 15000});
-            created_univs.push_back(u1);
-
-            office.add_university(std::move(uni1));
+    if (argc > 1) {
+        CampusConfig config;
+        string error;
+        auto start = chrono::steady_clock::now();
+        if (!config.load(argv[1], error)) {
+            printError("Campus config not loaded: " + error);
+        } else {
+            office.load_campus(config);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            printSuccess("Loaded " + to_string(config.universities.size()) + " universities and " +
+                         to_string(config.branch_count()) + " branches from " + argv[1] +
+                         " (" + to_string((int)ms) + " ms)");
         }
-
-        {
-            auto uni2 = make_unique<University>("Global Engineering College", 1, 75000);
-
-            unordered_map<string,int> cse_reserved2 = { {"OBC",4}, {"SC",2}, {"EWS",2} };
-            uni2->add_branch(make_unique<Branch>("Computer Science", 12, cse_reserved2, 1, 3000));
-
-            unordered_map<string,int> it_reserved = { {"OBC",3}, {"SC",2}, {"EWS",1} };
-            uni2->add_branch(make_unique<Branch>("Information Technology", 10, it_reserved, 1, 7000));
-
-            unordered_map<string,int> civil_reserved = { {"OBC",2}, {"SC",2}, {"ST",1} };
-            uni2->add_branch(make_unique<Branch>("Civil Engineering", 8, civil_reserved, 1, 20000));
-
-            UnivInfo u2;
-            u2.name = "Global Engineering College";
-            u2.opening_rank = 1;
-            u2.closing_rank = 75000;
-            u2.branches.push_back({"Computer Science", 12, cse_reserved2, 1, 3000});
-            u2.branches.push_back({"Information Technology", 10, it_reserved, 1, 7000});
-            u2.branches.push_back({"Civil Engineering", 8, civil_reserved, 1, 20000});
-            created_univs.push_back(u2);
-
-            office.add_university(std::move(uni2));
+    }
+    // ./main campus.conf applicants.csv also loads applicants, after the
+    // campus so their preferences match it
+    if (argc > 2) {
+        size_t skipped = 0;
+        string error;
+        auto start = chrono::steady_clock::now();
+        if (!applicants.load_csv(argv[2], skipped, error)) {
+            printError("Applicants not loaded: " + error);
+        } else {
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            office.publish_snapshot(applicants);
+            printSuccess("Loaded " + to_string(applicants.size()) + " applicants from " + argv[2] + " (" +
+                         to_string(skipped) + " malformed lines skipped, " + to_string((int)ms) + " ms)");
         }
+    }
 
+    auto create_sample_universities = [&]() {
+        printInfo("Creating sample universities...");
+        CampusConfig sample = default_campus();
+        sample.hostels.clear();             // keep the facilities chosen above
+        sample.messes.clear();
+        office.load_campus(sample);
         printSuccess("Added two sample universities with branch quotas!");
     };
 
@@ -211,6 +191,8 @@ int main() {
         cout << "8) Show admission summary" << endl;
         cout << "9) Show detailed reports" << endl;
         cout << "10) Export data to CSV" << endl;
+        cout << "11) Toggle tracing (currently "
+             << (Tracer::instance().enabled() ? "ON" : "OFF") << ")" << endl;
         cout << "0) Exit" << endl;
         cout << "Choose an option: ";
         string opt; getline(cin, opt);
@@ -235,11 +217,7 @@ int main() {
             int c = 100000;
             try { if(!trim(c_s).empty()) c = stoi(c_s); } catch(...) {}
 
-            auto uni = make_unique<University>(uname, o, c);
-            UnivInfo ui;
-            ui.name = uname;
-            ui.opening_rank = o;
-            ui.closing_rank = c;
+            CampusConfig::UniversitySpec spec{uname, std::max(1, o), std::max(std::max(1, o), c), false, false, {}};
 
             cout << "How many branches to add? ";
             string bcount_s;
@@ -268,22 +246,19 @@ int main() {
                 int bc = 100000;
                 try { if(!trim(bc_s).empty()) bc = stoi(bc_s); } catch(...) {}
 
-                unordered_map<string,int> reserved_map;
+                CampusConfig::BranchSpec branch{bname, std::max(0, seats), {}, std::max(1, bo), std::max(std::max(1, bo), bc)};
                 cout << "Enter reserved seats for categories (press Enter for 0):" << endl;
-                for (auto &cat : CATEGORIES) {
-                    if (cat == "General") continue;
-                    cout << "  " << cat << " seats: ";
+                for (int cat = 0; cat < CATEGORY_COUNT; ++cat) {
+                    if (CATEGORIES[cat] == "General") continue;
+                    cout << "  " << CATEGORIES[cat] << " seats: ";
                     string r_s; getline(cin, r_s);
                     int r = 0;
                     try { if(!trim(r_s).empty()) r = stoi(r_s); } catch(...) {}
-                    if (r > 0) reserved_map[cat] = r;
+                    branch.reserved[cat] = std::max(0, r);
                 }
-
-                uni->add_branch(make_unique<Branch>(bname, seats, reserved_map, bo, bc));
-                ui.branches.push_back({bname, seats, reserved_map, bo, bc});
+                spec.branches.push_back(std::move(branch));
             }
-            office.add_university(std::move(uni));
-            created_univs.push_back(ui);
+            office.add_university(spec);
             printSuccess("Custom university '" + uname + "' added successfully!");
         }
         else if (opt == "3") {
@@ -306,7 +281,7 @@ int main() {
             try { if(!trim(rank_s).empty()) rank = stoi(rank_s); } catch(...) {}
 
             string prefs;
-            cout << "Preferred branches (comma separated, e.g., Computer Science,Electronics): ";
+            cout << "Preferred branches (comma separated, e.g., Computer Science,Global Engineering College / Electronics): ";
             getline(cin, prefs);
             vector<string> preferences = split_preferences(prefs);
             if (preferences.empty()) preferences.push_back("Computer Science");
@@ -338,12 +313,24 @@ int main() {
             getline(cin, category);
             if (trim(category).empty()) category = "General";
 
-            applicants.emplace_back(name, income, rank, preferences, contact, perc, age, gender, category);
+            ApplicantHandle added;
+            {
+                MemoryScope mem(MEM_APPLICANTS);
+                added = applicants.emplace_back(name, income, rank, preferences, contact, perc, age, gender, category);
+            }
+            office.publish_snapshot(applicants);
             printSuccess("Applicant '" + name + "' added successfully!");
+            for (ProgramId p : applicants[added].get_preference_ids()) {
+                if (p == UNKNOWN_PROGRAM) {
+                    printWarning("Some preferences are not offered on this campus and will be ignored.");
+                    break;
+                }
+            }
             cout << "Current total applicants: " << applicants.size() << "\n";
         }
         else if (opt == "4") {
             printInfo("Generating demo applicants...");
+            MemoryScope mem(MEM_APPLICANTS);
             applicants.emplace_back("Anita Sharma", 200000, 1200,
                                   vector<string>{"Computer Science","Electronics"},
                                   "9991110001", 92, 18, "Female", "General");
@@ -362,6 +349,7 @@ int main() {
             applicants.emplace_back("Karan Mehta", 30000, 1500,
                                   vector<string>{"Information Technology","Computer Science"},
                                   "9991110006", 90, 18, "Male", "EWS");
+            office.publish_snapshot(applicants);
             printSuccess("Auto-generated 6 demo applicants!");
             cout << "Total applicants: " << applicants.size() << "\n";
         }
@@ -382,15 +370,16 @@ int main() {
         }
         else if (opt == "6") {
             printMenuHeader("UNIVERSITIES & BRANCHES STATUS");
-            if (created_univs.empty()) {
+            const CampusConfig& campus = office.get_campus();
+            if (campus.universities.empty()) {
                 printWarning("No universities created yet.");
             } else {
-                for (const auto &u : created_univs) {
+                for (const auto &u : campus.universities) {
                     cout << "University: " << u.name
                          << " | Rank Range: " << u.opening_rank << " - " << u.closing_rank << '\n';
                     for (const auto &b : u.branches) {
                         cout << "   - Branch: " << b.name
-                             << " | General: " << b.general
+                             << " | General: " << b.general_seats
                              << " | Rank: " << b.opening_rank << "-" << b.closing_rank << '\n';
                         cout << "     Reserved: ";
                         print_reserved_map(b.reserved);
@@ -436,6 +425,7 @@ int main() {
                 printSuccess("Processing complete!");
 
                 office.show_eligibility_report(applicants);
+                MemoryAccounting::print_report();
             }
         }
         else if (opt == "8") {
@@ -464,27 +454,49 @@ int main() {
             string fn; getline(cin, fn);
             if (trim(fn).empty()) fn = "admissions.csv";
 
+            TraceSpan span("export_csv", "export");
             ofstream out(fn);
             if (!out) {
                 printError("Failed to create file: " + fn);
             } else {
+                auto snap = office.snapshot();
                 out << "Roll,Name,JEE_Rank,12th_Percentage,Age,Gender,Category,Admitted,Branch,Hostel,Mess_Plan\n";
-                for (const auto &s : applicants) {
-                    out << s.get_roll() << ','
-                        << '"' << s.get_name() << '"' << ','
+                for (const auto &s : *snap->students) {
+                    out << s.roll << ','
+                        << '"' << s.name << '"' << ','
                         << s.jee_rank << ','
-                        << s.get_percentage_12th() << ','
-                        << s.get_age() << ','
-                        << s.get_gender() << ','
-                        << s.get_category() << ','
-                        << (s.is_admitted() ? "Yes" : "No") << ','
-                        << (s.is_admitted() ? s.get_preferences()[0] : "NA") << ','
-                        << (s.has_hostel() ? "Yes" : "No") << ','
-                        << (s.has_mess() ? s.get_mess_plan() : "No") << '\n';
+                        << s.percentage_12th << ','
+                        << s.age << ','
+                        << s.gender << ','
+                        << s.category << ','
+                        << (s.admitted ? "Yes" : "No") << ','
+                        << (s.admitted ? s.branch : "NA") << ','
+                        << (s.hostel ? "Yes" : "No") << ','
+                        << (s.mess ? s.mess_plan : "No") << '\n';
                 }
                 out.close();
                 printSuccess("Data exported successfully to: " + fn);
-                cout << "Records exported: " << applicants.size() << endl;
+                cout << "Records exported: " << snap->students->size() << endl;
+            }
+        }
+        else if (opt == "11") {
+            printMenuHeader("TRACING");
+            Tracer& tracer = Tracer::instance();
+            if (!tracer.enabled()) {
+                tracer.clear();
+                tracer.set_enabled(true);
+                printSuccess("Tracing enabled. Run the steps to profile, then choose 11 again.");
+            } else {
+                tracer.set_enabled(false);
+                cout << "Enter trace filename (e.g., admission_trace.json): ";
+                string fn; getline(cin, fn);
+                if (trim(fn).empty()) fn = "admission_trace.json";
+                if (tracer.write_chrome_trace(fn)) {
+                    printSuccess("Wrote " + to_string(tracer.event_count()) + " spans to " + fn);
+                    printInfo("Open it in chrome://tracing or ui.perfetto.dev");
+                } else {
+                    printError("Failed to write trace: " + fn);
+                }
             }
         }
         else if (opt == "0") {
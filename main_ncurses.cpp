@@ -17,51 +17,8 @@ using namespace std::chrono_literals;
 using namespace std;
 
 AdmissionOffice office;
-vector<Student> applicants;
-struct BranchInfo {
-    string name;
-    int general;
-    unordered_map<string,int> reserved;
-    int opening_rank;
-    int closing_rank;
-};
-struct UnivInfo {
-    string name;
-    int opening_rank;
-    int closing_rank;
-    vector<BranchInfo> branches;
-};
-vector<UnivInfo> created_univs;
+ApplicantStore applicants;
 
-template<typename T>
-auto student_contact_try(const T& s, int) -> decltype(std::string(s.get_contact())) {
-    return std::string(s.get_contact());
-}
-template<typename T>
-auto student_contact_try(const T& s, long) -> decltype(std::string(s.get_contact_number())) {
-    return std::string(s.get_contact_number());
-}
-template<typename T>
-auto student_contact_try(const T& s, short) -> decltype(std::string(s.get_phone())) {
-    return std::string(s.get_phone());
-}
-template<typename T>
-auto student_contact_try(const T& s, char) -> decltype(std::string(s.get_mobile())) {
-    return std::string(s.get_mobile());
-}
-template<typename T>
-auto student_contact_try(const T& s, signed char) -> decltype(std::string(s.contact())) {
-    return std::string(s.contact());
-}
-template<typename T>
-auto student_contact_try(const T& /*s*/, unsigned) -> std::string {
-    return std::string("N/A");
-}
-
-template<typename T>
-static std::string get_student_contact_safe(const T& s) {
-    return student_contact_try(s, 0);
-}
 static void pause_ms(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
 
 static string trim(const string &s) {
@@ -82,11 +39,6 @@ static vector<string> split_preferences(const string &line) {
     return out;
 }
 
-static void safe_add_university(unique_ptr<University> u, const UnivInfo &ui) {
-    office.add_university(std::move(u));
-    created_univs.push_back(ui);
-}
-
 void draw_progress(WINDOW* w, int y, int x, int width, float frac) {
     int filled = std::max(0, std::min(width, (int)std::round(frac * width)));
     mvwprintw(w, y, x, "[");
@@ -171,16 +123,14 @@ void print_table(WINDOW* w, int starty, const vector<string> &headers, const vec
     wrefresh(w);
 }
 
-string reserved_to_string(const unordered_map<string,int>& m) {
+string reserved_to_string(const array<int, CATEGORY_COUNT>& seats) {
     stringstream ss;
     bool first = true;
-    for (auto &cat : CATEGORIES) {
-        if (cat == "General") continue;
-        auto it = m.find(cat);
-        int v = (it == m.end() ? 0 : it->second);
-        if (v > 0) {
+    for (int c = 0; c < CATEGORY_COUNT; ++c) {
+        if (CATEGORIES[c] == "General") continue;
+        if (seats[c] > 0) {
             if (!first) ss << ",";
-            ss << cat << ":" << v;
+            ss << CATEGORIES[c] << ":" << seats[c];
             first = false;
         }
     }
@@ -190,43 +140,17 @@ string reserved_to_string(const unordered_map<string,int>& m) {
 
 // ----------------------------- Sample data helpers -----------------------------
 void createSampleUniversities() {
-    // similar to your sample creation but using our globals
-    {
-        auto uni1 = make_unique<University>("TechVille Institute of Technology", 1, 50000);
-        unordered_map<string,int> cse_reserved = { {"OBC",5}, {"SC",3}, {"ST",2}, {"EWS",2} };
-        uni1->add_branch(make_unique<Branch>("Computer Science", 15, cse_reserved, 1, 5000));
-        unordered_map<string,int> ece_reserved = { {"OBC",4}, {"SC",2}, {"EWS",2} };
-        uni1->add_branch(make_unique<Branch>("Electronics", 12, ece_reserved, 1, 8000));
-        unordered_map<string,int> mech_reserved = { {"OBC",3}, {"SC",2}, {"ST",1} };
-        uni1->add_branch(make_unique<Branch>("Mechanical", 10, mech_reserved, 1, 15000));
-
-        UnivInfo u1; u1.name = "TechVille Institute of Technology"; u1.opening_rank=1; u1.closing_rank=50000;
-        u1.branches.push_back({"Computer Science",15,cse_reserved,1,5000});
-        u1.branches.push_back({"Electronics",12,ece_reserved,1,8000});
-        u1.branches.push_back({"Mechanical",10,mech_reserved,1,15000});
-        safe_add_university(std::move(uni1), u1);
-    }
-
-    {
-        auto uni2 = make_unique<University>("Global Engineering College", 1, 75000);
-        unordered_map<string,int> cse_reserved2 = { {"OBC",4}, {"SC",2}, {"EWS",2} };
-        uni2->add_branch(make_unique<Branch>("Computer Science", 12, cse_reserved2, 1, 3000));
-        unordered_map<string,int> it_reserved = { {"OBC",3}, {"SC",2}, {"EWS",1} };
-        uni2->add_branch(make_unique<Branch>("Information Technology", 10, it_reserved, 1, 7000));
-        unordered_map<string,int> civil_reserved = { {"OBC",2}, {"SC",2}, {"ST",1} };
-        uni2->add_branch(make_unique<Branch>("Civil Engineering", 8, civil_reserved, 1, 20000));
-
-        UnivInfo u2; u2.name = "Global Engineering College"; u2.opening_rank=1; u2.closing_rank=75000;
-        u2.branches.push_back({"Computer Science",12,cse_reserved2,1,3000});
-        u2.branches.push_back({"Information Technology",10,it_reserved,1,7000});
-        u2.branches.push_back({"Civil Engineering",8,civil_reserved,1,20000});
-        safe_add_university(std::move(uni2), u2);
-    }
+    CampusConfig sample = default_campus();
+    sample.hostels.clear();         // facilities are set up at start
+    sample.messes.clear();
+    office.load_campus(sample);
 }
 
 // auto generate applicants
 void autoGenerateApplicants() {
+    MemoryScope mem(MEM_APPLICANTS);
     applicants.clear();
+    run_arena().release();      // previous run's names and preference lists
     applicants.emplace_back("Anita Sharma", 200000, 1200,
                           vector<string>{"Computer Science","Electronics"},
                           "9991110001", 92, 18, "Female", "General");
@@ -245,6 +169,7 @@ void autoGenerateApplicants() {
     applicants.emplace_back("Karan Mehta", 30000, 1500,
                           vector<string>{"Information Technology","Computer Science"},
                           "9991110006", 90, 18, "Male", "EWS");
+    office.publish_snapshot(applicants);
 }
 
 enum MenuItem {
@@ -258,6 +183,9 @@ enum MenuItem {
     MENU_SUMMARY,
     MENU_REPORTS,
     MENU_EXPORT,
+    MENU_TRACING,
+    MENU_MEMORY,
+    MENU_SHARED_SEATS,
     MENU_EXIT,
     MENU_COUNT
 };
@@ -273,6 +201,9 @@ const vector<string> MENU_LABELS = {
     "Admission summary",
     "Detailed reports",
     "Export CSV",
+    "Toggle tracing",
+    "Memory diagnostics",
+    "Live seats (shared)",
     "Exit"
 };
 
@@ -296,11 +227,11 @@ void draw_layout(WINDOW* header, WINDOW* sidebar, WINDOW* mainwin, WINDOW* foote
     werase(mainwin); box(mainwin, 0,0);
     center_text(mainwin, 1, "Welcome!", true);
     mvwprintw(mainwin, 3, 2, "Use the menu on the left or press number keys (1-%d).", (int)MENU_LABELS.size());
-    mvwprintw(mainwin, 5, 2, "Universities loaded: %zu | Applicants: %zu", created_univs.size(), applicants.size());
+    mvwprintw(mainwin, 5, 2, "Universities loaded: %zu | Applicants: %zu", office.get_campus().universities.size(), applicants.size());
     wrefresh(mainwin);
 
     werase(footer); box(footer, 0,0);
-    mvwprintw(footer, 1, 2, "Status: Ready");
+    mvwprintw(footer, 1, 2, "Status: Ready | Tracing: %s", Tracer::instance().enabled() ? "ON" : "OFF");
     wrefresh(footer);
 }
 
@@ -327,9 +258,9 @@ void show_applicants_window(WINDOW* mainwin) {
         mvwprintw(mainwin, y++, 2, "%-6s %-20s %-6s %-6s %-4s %-8s %-8s", "Roll", "Name", "JEE", "12th%", "Age", "Gender", "Category");
         mvwaddch(mainwin, y++, 1, ACS_HLINE);
         for (int i = 0; i < per_page && start + i < (int)applicants.size(); ++i) {
-            const Student &s = applicants[start + i];
+            const Student &s = applicants[applicants.handles()[start + i]];
             mvwprintw(mainwin, y++, 2, "%-6d %-20s %-6d %-6d %-4d %-8s %-8s",
-                      s.get_roll(), s.get_name().substr(0,20).c_str(), s.jee_rank, s.get_percentage_12th(), s.get_age(),
+                      s.get_roll(), string(s.get_name().substr(0,20)).c_str(), s.jee_rank, s.get_percentage_12th(), s.get_age(),
                       s.get_gender().c_str(), s.get_category().c_str());
         }
         mvwprintw(mainwin, mh-3, 2, "Page %d/%d - Use Left/Right to change, Enter to view details, q/Esc to return", page+1, pages);
@@ -354,10 +285,10 @@ void show_applicants_window(WINDOW* mainwin) {
                         WINDOW* win = newwin(h, w, sy, sx);
                         box(win,0,0);
                         center_text(win, 1, "Student Details", true);
-                        mvwprintw(win, 3, 2, "Name: %s", st.get_name().c_str());
+                        mvwprintw(win, 3, 2, "Name: %s", string(st.get_name()).c_str());
                         mvwprintw(win, 4, 2, "Roll: %d | JEE: %d | 12th%%: %d", st.get_roll(), st.jee_rank, st.get_percentage_12th());
                         mvwprintw(win, 5, 2, "Age: %d | Gender: %s | Category: %s", st.get_age(), st.get_gender().c_str(), st.get_category().c_str());
-                        std::string contact = get_student_contact_safe(st);
+                        std::string contact(st.get_contact_number());
                         mvwprintw(win, 6, 2, "Contact: %s", contact.c_str());
                         mvwprintw(win, 7, 2, "Preferences: ");
                         string prefs = "";
@@ -387,7 +318,8 @@ void show_applicants_window(WINDOW* mainwin) {
 
 // universities status view
 void show_universities_window(WINDOW* mainwin) {
-    if (created_univs.empty()) {
+    const vector<CampusConfig::UniversitySpec>& universities = office.get_campus().universities;
+    if (universities.empty()) {
         werase(mainwin); box(mainwin,0,0);
         center_text(mainwin, 1, "UNIVERSITIES & BRANCHES", true);
         mvwprintw(mainwin, 3, 2, "No universities created. Use 'Create sample universities' or 'Create custom university'.");
@@ -406,7 +338,7 @@ void show_universities_window(WINDOW* mainwin) {
         center_text(mainwin, 1, "UNIVERSITIES & BRANCHES", true);
 
         int total_lines = 0;
-        for (const auto& u : created_univs) {
+        for (const auto& u : universities) {
             total_lines += 3; // University name + rank info + separator
             total_lines += u.branches.size() * 4; // Each branch takes 4 lines
         }
@@ -424,8 +356,8 @@ void show_universities_window(WINDOW* mainwin) {
         int start_line = page * lines_per_page;
         int end_line = start_line + lines_per_page;
 
-        for (size_t i = 0; i < created_univs.size() && y < mh - 2; ++i) {
-            const auto &u = created_univs[i];
+        for (size_t i = 0; i < universities.size() && y < mh - 2; ++i) {
+            const auto &u = universities[i];
 
             // University header (2 lines)
             if (lines_used >= start_line && lines_used < end_line) {
@@ -444,7 +376,7 @@ void show_universities_window(WINDOW* mainwin) {
                     wattron(mainwin, A_BOLD);
                     mvwprintw(mainwin, y++, 6, "- %s", b.name.c_str());
                     wattroff(mainwin, A_BOLD);
-                    mvwprintw(mainwin, y++, 8, "General Seats: %d", b.general);
+                    mvwprintw(mainwin, y++, 8, "General Seats: %d", b.general_seats);
                     mvwprintw(mainwin, y++, 8, "Rank Range: %d - %d", b.opening_rank, b.closing_rank);
 
                     string reserved_str = reserved_to_string(b.reserved);
@@ -456,7 +388,7 @@ void show_universities_window(WINDOW* mainwin) {
             }
 
 
-            if (i < created_univs.size() - 1) {
+            if (i < universities.size() - 1) {
                 if (lines_used >= start_line && lines_used < end_line && y < mh - 2) {
                     mvwprintw(mainwin, y++, 2, "---");
                 }
@@ -500,6 +432,21 @@ void show_universities_window(WINDOW* mainwin) {
     exit_loop:
     keypad(mainwin, FALSE);
 }
+
+// string buffer whose growth is always charged to report memory, whatever
+// scope the code writing into it has open
+class ReportCapture : public std::stringbuf {
+protected:
+    int_type overflow(int_type c) override {
+        MemoryScope mem(MEM_REPORTS);
+        return std::stringbuf::overflow(c);
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        MemoryScope mem(MEM_REPORTS);
+        return std::stringbuf::xsputn(s, n);
+    }
+};
+
 void do_process_applications(WINDOW* mainwin) {
     if (applicants.empty()) {
         set_status("No applicants to process.", 1);
@@ -519,22 +466,25 @@ void do_process_applications(WINDOW* mainwin) {
         std::this_thread::sleep_for(80ms);
     }
 
-    std::ostringstream capture;
-    std::streambuf* old_buf = std::cout.rdbuf(capture.rdbuf());
-
+    // the office charges its own work to seat state; the captured log
+    // lines are report memory
+    ReportCapture capture;
+    std::streambuf* old_buf = std::cout.rdbuf(&capture);
     office.process_applications(applicants);
-
     std::cout.rdbuf(old_buf);
 
     set_status("Processing complete. Admissions allocated.", 3);
 
+    MemoryScope ui_mem(MEM_UI);
     std::string output = capture.str();
     if (!output.empty()) {
+        // page buffer for this screen only; dropped in one step on return
+        pmr::monotonic_buffer_resource page_arena(output.size() * 2 + 4096);
         std::istringstream iss(output);
-        std::vector<std::string> lines;
+        pmr::vector<pmr::string> lines(&page_arena);
         std::string line;
         while (std::getline(iss, line)) {
-            lines.push_back(line);
+            lines.emplace_back(line);
         }
 
         // Create a scrollable results window
@@ -560,7 +510,7 @@ void do_process_applications(WINDOW* mainwin) {
             int start_line = page * per_page;
             int y = 5;
             for (int i = 0; i < per_page && start_line + i < (int)lines.size(); ++i) {
-                const std::string& current_line = lines[start_line + i];
+                const pmr::string& current_line = lines[start_line + i];
 
                 if (current_line.find("Admitted") != std::string::npos ||
                     current_line.find("SUCCESS") != std::string::npos) {
@@ -625,89 +575,70 @@ void show_admission_summary(WINDOW* mainwin) {
     box(mainwin, 0, 0);
     center_text(mainwin, 1, "ADMISSION SUMMARY", true);
 
-    // Debug: Show what we know about applicants
-    mvwprintw(mainwin, 3, 2, "Total applicants in system: %zu", applicants.size());
-    wrefresh(mainwin);
-    pause_ms(500); // Brief pause to see the debug info
+    // Work on one published epoch so the counts below are consistent;
+    // every figure comes from the running counters, not from a rescan.
+    auto snap = office.snapshot();
+    const AdmissionStats& st = snap->stats;
+    size_t total = snap->students->size();
 
-    if (applicants.empty()) {
-        mvwprintw(mainwin, 5, 2, "No applicants found. Please add applicants first.");
-        mvwprintw(mainwin, 7, 2, "Press any key to return...");
+    if (total == 0) {
+        mvwprintw(mainwin, 3, 2, "No applicants found. Please add applicants first.");
+        mvwprintw(mainwin, 5, 2, "Press any key to return...");
         wrefresh(mainwin);
         wgetch(mainwin);
         return;
     }
 
-    // Try different ways to check admission status
-    int admitted_count = 0;
-    vector<const Student*> admitted_students;
-
-    for (const auto& student : applicants) {
-        // Try multiple possible methods to check admission status
-        bool is_admitted = false;
-
-        // Method 1: Direct method call
-        is_admitted = student.is_admitted();
-
-        // If that doesn't work, try to infer from preferences/branch allocation
-        if (!is_admitted && !student.get_preferences().empty()) {
-            // Check if first preference is set (as a proxy for admission)
-            string first_pref = student.get_preferences()[0];
-            if (!first_pref.empty() && first_pref != "N/A") {
-                is_admitted = true;
-            }
-        }
-
-        if (is_admitted) {
-            admitted_count++;
-            admitted_students.push_back(&student);
-        }
-    }
-
-    // Clear and show final summary
-    werase(mainwin);
-    box(mainwin, 0, 0);
-    center_text(mainwin, 1, "ADMISSION SUMMARY", true);
-
     // Show statistics
     mvwprintw(mainwin, 3, 2, "=== ADMISSION STATISTICS ===");
-    mvwprintw(mainwin, 4, 4, "Total Applicants: %zu", applicants.size());
-    mvwprintw(mainwin, 5, 4, "Admitted Students: %d", admitted_count);
-    mvwprintw(mainwin, 6, 4, "Not Admitted: %zu", applicants.size() - admitted_count);
+    mvwprintw(mainwin, 4, 4, "Total Applicants: %zu", total);
+    mvwprintw(mainwin, 5, 4, "Admitted Students: %zu", st.admitted);
+    mvwprintw(mainwin, 6, 4, "Not Admitted: %zu", total - st.admitted);
 
-    if (admitted_count > 0) {
-        double admission_rate = (admitted_count * 100.0) / applicants.size();
+    if (st.admitted > 0) {
+        double admission_rate = (st.admitted * 100.0) / total;
         mvwprintw(mainwin, 7, 4, "Admission Rate: %.1f%%", admission_rate);
     }
 
-    mvwprintw(mainwin, 9, 2, "=================================");
+    int y = 8;
+    mvwprintw(mainwin, y++, 4, "Hostel: %zu | Mess: %zu", st.hostel_allocated, st.mess_allocated);
+    string cats, plans;
+    for (auto &cat : CATEGORIES) cats += cat + "=" + to_string(st.count(st.admitted_by_category, cat)) + " ";
+    for (auto &plan : MESS_PLANS) plans += plan + "=" + to_string(st.count(st.mess_by_plan, plan)) + " ";
+    mvwprintw(mainwin, y++, 4, "By category: %s", cats.c_str());
+    mvwprintw(mainwin, y++, 4, "By gender: male=%zu female=%zu",
+              st.count(st.admitted_by_gender, "male"), st.count(st.admitted_by_gender, "female"));
+    mvwprintw(mainwin, y++, 4, "By mess plan: %s", plans.c_str());
+    for (const auto& u : snap->universities) {
+        if (y >= getmaxy(mainwin) - 8) break;
+        mvwprintw(mainwin, y++, 4, "%-40s %zu", u.name.substr(0, 40).c_str(),
+                  st.count(st.admitted_by_university, u.name));
+    }
+
+    mvwprintw(mainwin, y++, 2, "=================================");
 
     // Show admitted students
-    int y = 11;
-    if (admitted_count == 0) {
+    y++;
+    if (st.admitted == 0) {
         mvwprintw(mainwin, y, 2, "No students have been admitted yet.");
         mvwprintw(mainwin, y + 2, 2, "Run 'Process Applications' first to allocate admissions.");
     } else {
         mvwprintw(mainwin, y++, 2, "ADMITTED STUDENTS:");
         mvwprintw(mainwin, y++, 2, "------------------");
 
-        // Simple list without pagination for now
-        for (const auto* student : admitted_students) {
+        // Only as many rows as fit on screen are visited
+        for (const auto& student : *snap->students) {
             if (y >= getmaxy(mainwin) - 2) break;
-
-            string branch = "Not Assigned";
-            if (!student->get_preferences().empty()) {
-                branch = student->get_preferences()[0];
-            }
+            if (!student.admitted) continue;
 
             // Truncate long names for display
-            string name = student->get_name();
+            string name = student.name;
             if (name.length() > 25) {
                 name = name.substr(0, 22) + "...";
             }
 
             mvwprintw(mainwin, y++, 4, "Roll: %-6d %-25s -> %s",
-                     student->get_roll(), name.c_str(), branch.c_str());
+                     student.roll, name.c_str(), student.branch.c_str());
         }
     }
 
@@ -721,29 +652,132 @@ void export_csv_window(WINDOW* mainwin) {
         set_status("Export cancelled.", 3);
         return;
     }
+    TraceSpan span("export_csv", "export");
     ofstream out(fn);
     if (!out) {
         set_status("Failed to create file: " + fn, 1);
         return;
     }
+    auto snap = office.snapshot();
     out << "Roll,Name,JEE_Rank,12th_Percentage,Age,Gender,Category,Admitted,Branch,Hostel,Mess_Plan\n";
-    for (const auto &s : applicants) {
-        out << s.get_roll() << ','
-            << '"' << s.get_name() << '"' << ','
+    for (const auto &s : *snap->students) {
+        out << s.roll << ','
+            << '"' << s.name << '"' << ','
             << s.jee_rank << ','
-            << s.get_percentage_12th() << ','
-            << s.get_age() << ','
-            << s.get_gender() << ','
-            << s.get_category() << ','
-            << (s.is_admitted() ? "Yes" : "No") << ','
-            << (s.is_admitted() ? s.get_preferences()[0] : "NA") << ','
-            << (s.has_hostel() ? "Yes" : "No") << ','
-            << (s.has_mess() ? s.get_mess_plan() : "No") << '\n';
+            << s.percentage_12th << ','
+            << s.age << ','
+            << s.gender << ','
+            << s.category << ','
+            << (s.admitted ? "Yes" : "No") << ','
+            << (s.admitted ? s.branch : "NA") << ','
+            << (s.hostel ? "Yes" : "No") << ','
+            << (s.mess ? s.mess_plan : "No") << '\n';
     }
     out.close();
     set_status("Exported to " + fn, 2);
 }
 
+// tracing on/off; turning it off writes the Chrome trace
+void toggle_tracing(WINDOW* mainwin) {
+    Tracer& tracer = Tracer::instance();
+    if (!tracer.enabled()) {
+        tracer.clear();
+        tracer.set_enabled(true);
+        set_status("Tracing ON. Select 'Toggle tracing' again to save the trace.", 3);
+        return;
+    }
+    tracer.set_enabled(false);
+    string fn = input_modal("Save Trace", "Trace filename (blank -> admission_trace.json):", 100);
+    if (fn.empty()) fn = "admission_trace.json";
+    if (tracer.write_chrome_trace(fn)) {
+        set_status("Tracing OFF. " + to_string(tracer.event_count()) + " spans written to " + fn, 2);
+    } else {
+        set_status("Failed to write trace: " + fn, 1);
+    }
+}
+
+// memory diagnostics panel
+void show_memory_window(WINDOW* mainwin) {
+    werase(mainwin); box(mainwin, 0, 0);
+    center_text(mainwin, 1, "MEMORY DIAGNOSTICS", true);
+    mvwprintw(mainwin, 3, 2, "%-12s %14s %14s %12s %12s", "Subsystem", "Live bytes", "Peak bytes", "Allocs", "Frees");
+    mvwhline(mainwin, 4, 1, ACS_HLINE, getmaxx(mainwin) - 2);
+    long long live_total = 0, peak_total = 0;
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+        MemoryUsage u = MemoryAccounting::usage((MemTag)t);
+        live_total += u.live_bytes;
+        peak_total += u.peak_bytes;
+        mvwprintw(mainwin, 5 + t, 2, "%-12s %14lld %14lld %12lld %12lld", MEM_TAG_NAMES[t],
+                  u.live_bytes, u.peak_bytes, u.allocations, u.frees);
+    }
+    mvwhline(mainwin, 5 + MEM_TAG_COUNT, 1, ACS_HLINE, getmaxx(mainwin) - 2);
+    mvwprintw(mainwin, 6 + MEM_TAG_COUNT, 2, "%-12s %14lld %14lld", "total", live_total, peak_total);
+    if (!applicants.empty()) {
+        MemoryUsage a = MemoryAccounting::usage(MEM_APPLICANTS);
+        mvwprintw(mainwin, 8 + MEM_TAG_COUNT, 2, "Applicant bytes per student: %lld",
+                  a.live_bytes / (long long)applicants.size());
+    }
+    mvwprintw(mainwin, getmaxy(mainwin) - 2, 2, "Press any key to return...");
+    wrefresh(mainwin);
+    wgetch(mainwin);
+}
+
+// live seat matrix published by the admission daemon; redraws twice a
+// second straight from the shared-memory segment until a key is pressed
+void show_shared_seats_window(WINDOW* mainwin) {
+    const char* env = getenv("ADMISSION_SEAT_SHM");
+    string shm_name = env && *env ? env : "/admission_seats";
+    SeatTableReader reader(shm_name);
+    if (!reader.is_open()) {
+        set_status("No seat table at " + shm_name + " (is admission_daemon running?)", 1);
+        return;
+    }
+
+    int mh = getmaxy(mainwin);
+    SeatTableData table;
+    wtimeout(mainwin, 500);
+    keypad(mainwin, TRUE);
+    while (true) {
+        werase(mainwin); box(mainwin, 0, 0);
+        center_text(mainwin, 1, "LIVE SEATS (" + shm_name + ")", true);
+        if (!reader.read(table)) {
+            mvwprintw(mainwin, 3, 2, "Seat table busy, retrying...");
+        } else {
+            mvwprintw(mainwin, 3, 2, "Epoch %llu | Applicants: %lld | Admitted: %lld | Hostel: %lld | Mess: %lld",
+                      (unsigned long long)table.epoch, (long long)table.applicants, (long long)table.admitted,
+                      (long long)table.hostel_allocated, (long long)table.mess_allocated);
+            if (table.truncated) {
+                mvwprintw(mainwin, 4, 2, "Showing %u of %u universities, %u of %u branches (seat table full)",
+                          table.university_count, table.total_universities,
+                          table.branch_count, table.total_branches);
+            }
+            int y = 5;
+            for (uint32_t u = 0; u < table.university_count && y < mh - 3; ++u) {
+                const auto& ur = table.universities[u];
+                wattron(mainwin, A_BOLD);
+                mvwprintw(mainwin, y++, 2, "%s (ranks %d-%d, admitted %d)", ur.name,
+                          ur.opening_rank, ur.closing_rank, ur.admitted);
+                wattroff(mainwin, A_BOLD);
+                for (uint32_t b = ur.first_branch; b < ur.first_branch + ur.branch_count && y < mh - 3; ++b) {
+                    const auto& br = table.branches[b];
+                    string reserved;
+                    for (int c = 0; c < SeatTableData::CATEGORY_COUNT; ++c) {
+                        if (br.reserved_remaining[c] > 0) {
+                            reserved += " " + CATEGORIES[c] + ":" + to_string(br.reserved_remaining[c]);
+                        }
+                    }
+                    mvwprintw(mainwin, y++, 4, "%-24s General: %-4d%s", br.name, br.general_remaining, reserved.c_str());
+                }
+                ++y;
+            }
+        }
+        mvwprintw(mainwin, mh - 2, 2, "Updating live - press any key to return...");
+        wrefresh(mainwin);
+        if (wgetch(mainwin) != ERR) break;
+    }
+    wtimeout(mainwin, -1);
+}
+
 // create custom university modal
 void create_custom_university(WINDOW* mainwin) {
     string uname = input_modal("New University", "University name (blank -> 'Custom University'):", 80);
@@ -758,8 +792,7 @@ void create_custom_university(WINDOW* mainwin) {
     int bcount = 0; if (!bcount_s.empty()) bcount = atoi(bcount_s.c_str());
     bcount = std::max(0, std::min(10, bcount));
 
-    auto uni = make_unique<University>(uname, o, c);
-    UnivInfo ui; ui.name = uname; ui.opening_rank = o; ui.closing_rank = c;
+    CampusConfig::UniversitySpec spec{uname, std::max(1, o), std::max(std::max(1, o), c), false, false, {}};
 
     for (int i = 0; i < bcount; ++i) {
         string bname = input_modal("Branch", ("Branch " + to_string(i+1) + " name:").c_str(), 50);
@@ -771,22 +804,18 @@ void create_custom_university(WINDOW* mainwin) {
         string bc_s = input_modal("Branch closing rank", "Closing rank (default 100000):", 6);
         int bc = 100000; if (!bc_s.empty()) bc = atoi(bc_s.c_str());
 
-        unordered_map<string,int> reserved_map;
+        CampusConfig::BranchSpec branch{bname, std::max(0, seats), {}, std::max(1, bo), std::max(std::max(1, bo), bc)};
         // ask for non-general categories
-        for (auto &cat : CATEGORIES) {
-            if (cat == "General") continue;
-            string prompt = cat + " seats (press Enter for 0):";
+        for (int cat = 0; cat < CATEGORY_COUNT; ++cat) {
+            if (CATEGORIES[cat] == "General") continue;
+            string prompt = CATEGORIES[cat] + " seats (press Enter for 0):";
             string r_s = input_modal("Reserved seats", prompt.c_str(), 6);
-            if (!r_s.empty()) {
-                int r = atoi(r_s.c_str());
-                if (r > 0) reserved_map[cat] = r;
-            }
+            if (!r_s.empty()) branch.reserved[cat] = std::max(0, atoi(r_s.c_str()));
         }
-        uni->add_branch(make_unique<Branch>(bname, seats, reserved_map, bo, bc));
-        ui.branches.push_back({bname, seats, reserved_map, bo, bc});
+        spec.branches.push_back(std::move(branch));
     }
 
-    safe_add_university(std::move(uni), ui);
+    office.add_university(spec);
     set_status("Custom university added: " + uname, 2);
 }
 
@@ -798,7 +827,7 @@ void add_applicant_modal(WINDOW* mainwin) {
     int income = 500000; if (!income_s.empty()) income = atoi(income_s.c_str());
     string rank_s = input_modal("JEE Rank", "JEE Rank (integer, default 5000):", 10);
     int rank = 5000; if (!rank_s.empty()) rank = atoi(rank_s.c_str());
-    string prefs = input_modal("Preferences", "Preferred branches (comma separated):", 200);
+    string prefs = input_modal("Preferences", "Branches or University / Branch (comma separated):", 200);
     auto preferences = split_preferences(prefs);
     if (preferences.empty()) preferences.push_back("Computer Science");
     string contact = input_modal("Contact", "Contact number (optional):", 20);
@@ -812,12 +841,23 @@ void add_applicant_modal(WINDOW* mainwin) {
     string category = input_modal("Category", "Category (General/OBC/SC/ST/EWS, default General):", 10);
     if (category.empty()) category = "General";
 
-    applicants.emplace_back(name, income, rank, preferences, contact, perc, age, gender, category);
-    set_status("Added applicant: " + name, 2);
+    ApplicantHandle added;
+    {
+        MemoryScope mem(MEM_APPLICANTS);
+        added = applicants.emplace_back(name, income, rank, preferences, contact, perc, age, gender, category);
+    }
+    office.publish_snapshot(applicants);
+    const auto& ids = applicants[added].get_preference_ids();
+    if (find(ids.begin(), ids.end(), UNKNOWN_PROGRAM) != ids.end()) {
+        set_status("Added applicant: " + name + " (some preferences are not offered here)", 1);
+    } else {
+        set_status("Added applicant: " + name, 2);
+    }
 }
 
 // ----------------------------- Main -----------------------------
-int main() {
+// main_ncurses [campus.conf] -- loads the campus config on start.
+int main(int argc, char** argv) {
     // init ncurses
     initscr();
     cbreak();
@@ -847,6 +887,8 @@ int main() {
     WINDOW* mainwin = newwin(main_h, main_w, header_h, sidebar_w);
     WINDOW* footer = newwin(footer_h, COLS, header_h + main_h, 0);
 
+    office.export_metrics_from_env();
+
     // initialize system defaults (hostel/mess)
     // set up facilities similar to your initializeSystem
     {
@@ -863,6 +905,12 @@ int main() {
     int selected = 0;
     draw_layout(header, sidebar, mainwin, footer, selected);
     set_status("Ready. Use arrow keys or number keys to navigate.", 3);
+    if (argc > 1) {
+        CampusConfig config;
+        string error;
+        if (config.load(argv[1], error)) office.load_campus(config);
+        else set_status("Campus config not loaded: " + error, 1);
+    }
 
     bool running = true;
     while (running) {
@@ -912,16 +960,20 @@ int main() {
                     break;
                 case MENU_REPORTS:
                 {
+                    MemoryScope mem(MEM_REPORTS);
                     std::ostringstream capture;
                     std::streambuf* old_buf = std::cout.rdbuf(capture.rdbuf());
                     office.show_detailed_report();
                     std::cout.rdbuf(old_buf);
+                    MemoryScope ui_mem(MEM_UI);
 
                     // 2. Convert captured output into lines
-                    std::istringstream iss(capture.str());
-                    std::vector<std::string> lines;
+                    std::string output = capture.str();
+                    pmr::monotonic_buffer_resource page_arena(output.size() * 2 + 4096);
+                    std::istringstream iss(output);
+                    pmr::vector<pmr::string> lines(&page_arena);
                     std::string line;
-                    while (std::getline(iss, line)) lines.push_back(line);
+                    while (std::getline(iss, line)) lines.emplace_back(line);
 
                     // 3. Pause ncurses & clear its content before redrawing
                     clear();            // remove everything drawn by ncurses
@@ -964,6 +1016,15 @@ int main() {
                 case MENU_EXPORT:
                     export_csv_window(mainwin);
                     break;
+                case MENU_TRACING:
+                    toggle_tracing(mainwin);
+                    break;
+                case MENU_MEMORY:
+                    show_memory_window(mainwin);
+                    break;
+                case MENU_SHARED_SEATS:
+                    show_shared_seats_window(mainwin);
+                    break;
                 case MENU_EXIT:
                     running = false;
                     break;
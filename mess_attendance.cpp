@@ -0,0 +1,146 @@
+#include "functions.cpp"
+#include <fstream>
+
+using namespace std;
+
+// Mess attendance monitor. Counts meal taps into headcounts per outlet,
+// plan and meal slot while they arrive.
+//
+//   mess_attendance --roster admitted.csv [--campus FILE] [--threads N]
+//                   [--every SECONDS] [--utc-offset MINUTES] events
+//
+// events is a file, a named pipe or "-" for standard input, one tap per
+// line: "unix_time,outlet,roll" with outlets numbered as the mess lines of
+// the --campus config (the sample campus without one). Plans come from the
+// Roll and Mess_Plan columns of an admission export (admission_batch -o).
+// Every --every seconds (default 5) the current slot's headcount is
+// printed; at the end, that and the week's trend. Times are local at
+// --utc-offset (default 330, IST).
+
+static string slot_label(int64_t slot) {
+    if (slot < 0) return "no meal yet";
+    time_t day = (time_t)(slot / MEAL_SLOTS) * 86400;
+    tm t;
+    gmtime_r(&day, &t);
+    char date[16];
+    strftime(date, sizeof date, "%Y-%m-%d", &t);
+    return string(date) + " " + meal_name((Meal)(slot % MEAL_SLOTS));
+}
+
+static void print_headcount(const MessAttendance& att, const vector<string>& outlets) {
+    int64_t slot = att.current_slot();
+    MessAttendance::Headcount count = att.headcount(slot);
+    cout << slot_label(slot) << ":";
+    for (int o = 0; o < att.get_outlets(); ++o) {
+        uint64_t sum = count[o][0] + count[o][1] + count[o][2];
+        cout << " | " << outlets[o] << " " << sum << " (";
+        for (int p = 0; p < MessAttendance::PLANS; ++p) cout << (p ? " " : "") << MESS_PLANS[p] << " " << count[o][p];
+        cout << ")";
+    }
+    cout << endl;
+}
+
+int main(int argc, char** argv) {
+    string roster_path;
+    string campus_path;
+    string events;
+    unsigned threads = 0;
+    int every = 5;
+    int offset_minutes = 330;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--roster" && i + 1 < argc) roster_path = argv[++i];
+        else if (arg == "--campus" && i + 1 < argc) campus_path = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) threads = (unsigned)std::max(1, atoi(argv[++i]));
+        else if (arg == "--every" && i + 1 < argc) every = std::max(1, atoi(argv[++i]));
+        else if (arg == "--utc-offset" && i + 1 < argc) offset_minutes = atoi(argv[++i]);
+        else if (events.empty() && (arg == "-" || arg[0] != '-')) events = arg;
+        else {
+            events.clear();
+            break;
+        }
+    }
+    if (events.empty() || roster_path.empty()) {
+        cerr << "usage: " << argv[0] << " --roster admitted.csv [--campus FILE] [--threads N]"
+             << " [--every SECONDS] [--utc-offset MINUTES] events" << endl;
+        return 2;
+    }
+
+    CampusConfig campus = default_campus();
+    string error;
+    if (!campus_path.empty() && !campus.load(campus_path, error)) {
+        cerr << "mess_attendance: " << error << endl;
+        return 1;
+    }
+    vector<string> outlets;
+    for (const auto& m : campus.messes) outlets.push_back(m.name);
+    if (outlets.empty()) outlets.push_back("Mess");
+
+    if (threads == 0) threads = std::max(1u, std::min(8u, thread::hardware_concurrency()));
+    MessAttendance att((int)outlets.size(), threads, offset_minutes * 60);
+
+    ifstream roster(roster_path);
+    if (!roster) {
+        cerr << "mess_attendance: cannot open " << roster_path << endl;
+        return 1;
+    }
+    string line;
+    size_t planned = 0;
+    while (getline(roster, line)) {
+        size_t last = line.rfind(',');
+        MessPlan plan;
+        if (last == string::npos || !isdigit((unsigned char)line[0])) continue;
+        if (!parse_mess_plan(line.substr(last + 1), plan)) continue;
+        att.set_plan(atoi(line.c_str()), plan);
+        ++planned;
+    }
+
+    int fd = events == "-" ? 0 : open(events.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "mess_attendance: cannot open " << events << endl;
+        return 1;
+    }
+    cerr << "mess_attendance: " << planned << " students with a plan, " << outlets.size()
+         << " outlets, " << threads << " ingest threads" << endl;
+
+    // Reports run beside the ingest until it returns.
+    mutex lock;
+    condition_variable done_cv;
+    bool done = false;
+    thread reporter([&] {
+        unique_lock<mutex> guard(lock);
+        while (!done_cv.wait_for(guard, chrono::seconds(every), [&] { return done; })) {
+            print_headcount(att, outlets);
+        }
+    });
+
+    auto start = chrono::steady_clock::now();
+    size_t lines = att.ingest(fd);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (fd != 0) close(fd);
+    {
+        lock_guard<mutex> guard(lock);
+        done = true;
+    }
+    done_cv.notify_all();
+    reporter.join();
+
+    MessAttendance::Totals t = att.totals();
+    cerr << "mess_attendance: " << lines << " taps in " << fixed << setprecision(2) << secs << "s ("
+         << (size_t)(lines / std::max(secs, 1e-9)) << "/s) | counted " << t.counted << " | unknown "
+         << t.unknown << " | off hours " << t.off_hours << " | late " << t.late << " | malformed "
+         << t.malformed << endl;
+
+    printSection("CURRENT SLOT");
+    print_headcount(att, outlets);
+
+    printSection("WEEKLY TREND");
+    int64_t slot = att.current_slot();
+    vector<uint64_t> trend = att.weekly_trend(slot);
+    for (int k = 0; k < MessAttendance::TREND_SLOTS; ++k) {
+        int64_t s = slot - (MessAttendance::TREND_SLOTS - 1) + k;
+        if (s < 0) continue;
+        cout << setw(22) << left << slot_label(s) << right << setw(10) << trend[k] << endl;
+    }
+    return 0;
+}
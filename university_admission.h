@@ -10,119 +10,1097 @@ class Hostel;
 class Mess;
 class University;
 class AdmissionOffice;
+class AdmissionSnapshot;
+class ExternalMeritSorter;
 
 static const vector<string> CATEGORIES = {"General","OBC","SC","ST","EWS"};
 static const vector<string> MESS_PLANS = {"Basic", "Standard", "Premium"};
 
+// Compact applicant encoding. Gender, category and mess plan are small
+// codes, branch names are interned once and referred to by a 16-bit id,
+// and names/contact numbers live in a shared append-only string pool.
+enum class Gender : unsigned char { Male = 0, Female = 1 };
+enum class Category : unsigned char { General = 0, OBC, SC, ST, EWS };   // CATEGORIES order
+enum class MessPlan : unsigned char { Basic = 0, Standard, Premium };     // MESS_PLANS order
+static const int CATEGORY_COUNT = 5;
+
+typedef uint16_t BranchId;
+static const BranchId NO_BRANCH = 0xFFFF;
+
+Gender parse_gender(string);
+Category parse_category(const string&);
+bool parse_mess_plan(const string&, MessPlan&);
+const string& gender_name(Gender);
+const string& category_name(Category);
+const string& mess_plan_name(MessPlan);
+
+// Interned branch names, shared by every university.
+BranchId intern_branch(const string&);
+BranchId find_branch_id(const string&);
+const string& branch_name(BranchId);
+
+// A program is one (university, branch) pair, interned like branch names.
+// Preferences are a flat ranked list of programs written "University /
+// Branch"; a bare branch name is a program with no university and stands
+// for that branch at every university. Only universities and branches
+// already created are interned; any other name becomes UNKNOWN_PROGRAM,
+// which no seat matches, so the tables stay bounded by the campus
+// whatever applicants write.
+typedef uint16_t ProgramId;
+static const ProgramId NO_PROGRAM = 0xFFFF;
+static const ProgramId UNKNOWN_PROGRAM = 0xFFFE;
+
+void register_university(const string&);
+ProgramId intern_program(const string&);
+size_t program_count();
+const string& program_university(ProgramId);   // empty when any university
+BranchId program_branch(ProgramId);
+string program_name(ProgramId);
+
+// Append-only pool for short strings. A reference is a 32-bit offset; the
+// pool is split into fixed 64 KiB chunks so references never move. Each
+// thread fills a chunk of its own and takes the lock only to start the
+// next one; get() reads the chunk table without any lock.
+class StringPool {
+public:
+    static const uint32_t CHUNK_BITS = 16;
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const uint32_t MAX_CHUNKS = 1u << 16;
+    static const size_t MAX_LENGTH = 255;
+
+private:
+    pmr::memory_resource* upstream;
+    array<char*, MAX_CHUNKS> chunks;    // slot set before any reference into it exists
+    atomic<uint32_t> chunk_count;
+    atomic<uint64_t> generation;        // bumped by reset(); drops every thread's chunk
+    char* spare;                // chunk given back by rewind(), reused first
+    atomic<size_t> bytes;
+    mutex lock;                 // taken to hand out a chunk
+
+    uint32_t take_chunk(uint64_t& chunk_generation);
+
+public:
+    struct Mark {
+        uint32_t chunks;
+        uint32_t thread_chunk;
+        uint32_t used_in_chunk;     // CHUNK_SIZE when the thread had no chunk
+    };
+
+    explicit StringPool(pmr::memory_resource* upstream_);
+    void reset();
+    uint32_t add(string_view, uint8_t& length);
+    Mark mark() const;
+    void rewind(Mark);
+    string_view get(uint32_t ref, uint8_t length) const {
+        if (length == 0) return string_view();
+        return string_view(chunks[ref >> CHUNK_BITS] + (ref & (CHUNK_SIZE - 1)), length);
+    }
+    size_t size_bytes() const { return bytes.load(memory_order_relaxed); }
+};
+
+// Run-scoped arena. Applicant strings, spilled preference lists and other
+// per-run buffers come from one monotonic resource; nothing is freed
+// individually and release() drops the whole run in one step. Every
+// Student created since the last release must be gone before calling it.
+// Small blocks come from a 64 KiB slab per thread, so only refills and
+// large blocks take the lock.
+class RunArena : public pmr::memory_resource {
+public:
+    static const size_t SLAB_SIZE = 64 * 1024;
+
+private:
+    mutex lock;
+    pmr::monotonic_buffer_resource arena;
+    StringPool pool;
+    atomic<size_t> reserved;
+    atomic<uint64_t> generation;    // bumped by release(); drops every thread's slab
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override { }
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    RunArena();
+    StringPool& strings() { return pool; }
+    size_t bytes_reserved() const { return reserved.load(memory_order_relaxed); }
+    void release();
+};
+
+// Process-wide arena for applicant data. It holds only live applicants, so
+// it is released where the whole population is dropped: the ncurses
+// frontend before generating a new sample set. main.cpp, the daemon and
+// admission_batch keep their applicants until exit and never release it.
+// Per-run scratch does not come from here; each run owns its own.
+RunArena& run_arena();
+StringPool& applicant_strings();
+
+// Where this thread's SmallVectors spill: the run arena, unless a
+// SpillScope points them at a scratch resource the caller resets once the
+// owning object is gone or copied out.
+pmr::memory_resource& spill_resource();
+
+class SpillScope {
+private:
+    pmr::memory_resource* previous;
+
+public:
+    explicit SpillScope(pmr::memory_resource& scratch);
+    SpillScope(const SpillScope&) = delete;
+    SpillScope& operator=(const SpillScope&) = delete;
+    ~SpillScope();
+};
+
+// Vector with N elements stored inline; spills into spill_resource() beyond
+// that.
+template<typename T, unsigned N>
+class SmallVector {
+private:
+    union {
+        T inline_items[N];
+        T* heap_items;
+    };
+    uint16_t count;
+    uint16_t capacity;
+
+    bool spilled() const { return capacity > N; }
+    T* items() { return spilled() ? heap_items : inline_items; }
+    const T* items() const { return spilled() ? heap_items : inline_items; }
+
+public:
+    SmallVector() : count(0), capacity(N) { }
+    SmallVector(const SmallVector& o) : count(0), capacity(N) {
+        reserve(o.count);
+        copy(o.begin(), o.end(), items());
+        count = o.count;
+    }
+    SmallVector(SmallVector&& o) noexcept : count(o.count), capacity(o.capacity) {
+        if (o.spilled()) heap_items = o.heap_items;
+        else copy(o.inline_items, o.inline_items + o.count, inline_items);
+        o.count = 0;
+        o.capacity = N;
+    }
+    SmallVector& operator=(SmallVector o) noexcept {
+        this->~SmallVector();
+        new (this) SmallVector(std::move(o));
+        return *this;
+    }
+    ~SmallVector() = default;      // spilled storage belongs to its resource
+
+    void reserve(size_t n) {
+        if (n <= capacity) return;
+        n = std::min<size_t>(std::max<size_t>(n, 2u * capacity), 0xFFFF);
+        T* grown = static_cast<T*>(spill_resource().allocate(n * sizeof(T), alignof(T)));
+        copy(items(), items() + count, grown);
+        heap_items = grown;
+        capacity = (uint16_t)n;
+    }
+    void push_back(T v) {
+        if (count == 0xFFFF) return;
+        if (count == capacity) reserve(count + 1);
+        items()[count++] = v;
+    }
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool is_inline() const { return !spilled(); }
+    T operator[](size_t i) const { return items()[i]; }
+    const T* begin() const { return items(); }
+    const T* end() const { return items() + count; }
+};
+
+// Roll numbers are handed out in per-thread blocks carved off one atomic
+// counter, so Students can be constructed on several threads without a
+// shared lock. Rolls are unique but only ordered within a thread; bulk
+// loaders take a contiguous range with reserve() and renumber by input order.
+class RollAllocator {
+public:
+    static const int BLOCK = 256;
+    static int next();
+    static int reserve(int count);
+
+private:
+    static atomic<int> next_free;
+};
+
+// Beds are numbered within their hostel; see Hostel.
+static const uint32_t NO_BED = 0xFFFFFFFFu;
+
 class Student {
 private:
-    static int next_roll;
     int roll_number;
-    string name;
     int income;
-    vector<string> preferred_branches;
-    string contact_number;
-    int age;
-    string gender;
-    string category;
-    bool admitted;
-    bool hostel_allocated;
-    bool mess_allocated;
-    string mess_plan;
+    uint32_t name_ref;
+    uint32_t contact_ref;
+    uint8_t name_length;
+    uint8_t contact_length;
+    uint8_t age;
+    uint8_t percentage_12th;
+    uint16_t gender : 1;
+    uint16_t category : 3;
+    uint16_t mess_plan : 2;
+    uint16_t admitted : 1;
+    uint16_t hostel_allocated : 1;
+    uint16_t mess_allocated : 1;
+    uint16_t ranked_programs : 1;   // some preference names its university
+    uint16_t mess_outlet : 6;       // index into the office's outlets
+    BranchId assigned_branch;
+    SmallVector<ProgramId, 4> preferred_programs;
+    uint32_t hostel_bed;
 
 public:
-    string assigned_branch;
-    int percentage_12th;
     int jee_rank;
 
-    Student(string, int, int, vector<string>, string, int, int, string, string);
+    // roll 0 draws the next roll from RollAllocator
+    Student(string, int, int, vector<string>, string, int, int, string, string, int roll = 0);
+    Student(const Student&) = default;
+    Student(Student&&) noexcept = default;
+    Student& operator=(const Student&) = default;
+    Student& operator=(Student&&) noexcept = default;
     bool is_eligible(int = 60, int = 17) const;
-    void assign_roll();
+    void assign_roll(int roll);
     int get_percentage_12th() const;
-    void set_admitted(const string&);
+    void set_admitted(BranchId);
     bool is_admitted() const;
-    const string& get_name() const;
+    string_view get_name() const;
+    string_view get_contact_number() const;
     int get_income() const;
-    const vector<string>& get_preferences() const;
+    vector<string> get_preferences() const;
+    const SmallVector<ProgramId, 4>& get_preference_ids() const;
+    bool has_ranked_programs() const;
     const string& get_gender() const;
+    Gender get_gender_code() const;
     const string& get_category() const;
+    Category get_category_code() const;
+    BranchId get_assigned_branch_id() const;
+    const string& get_assigned_branch() const;
     int get_roll() const;
     int get_age() const;
     bool scholarship_eligible(int, const string&) const;
-    void allocate_hostel();
+    void allocate_hostel(uint32_t bed);
+    void release_hostel();
     bool has_hostel() const;
-    void allocate_mess(const string& plan = "Standard");
+    uint32_t get_hostel_bed() const;
+    void allocate_mess(MessPlan plan = MessPlan::Standard, int outlet = 0);
     bool has_mess() const;
+    int get_mess_outlet() const;
     const string& get_mess_plan() const;
+    MessPlan get_mess_plan_code() const;
     void print_details() const;
     void print_detailed_info() const;
     ~Student();
 };
 
+// Applicants are addressed by 32-bit handles into an ApplicantStore rather
+// than by Student*. A handle stays valid while the store grows, and rosters
+// built from handles can be copied into snapshots or written out as-is.
+// Handles are positions, so they are handed out again after clear() or
+// pop_back(); clear() moves the store to a new generation, which tells
+// rosters kept from before that their handles no longer apply.
+using ApplicantHandle = uint32_t;
+static const ApplicantHandle NO_APPLICANT = 0xFFFFFFFFu;
+
+class ApplicantStore {
+private:
+    vector<Student> students;       // indexed by handle, never reordered
+    vector<ApplicantHandle> order;  // listing order; merit order after a run
+    uint64_t generation;            // unique per store and per clear()
+
+public:
+    ApplicantStore();
+
+    template <class Rows, class Ref>
+    class basic_iterator {
+    private:
+        vector<ApplicantHandle>::const_iterator pos;
+        Rows* rows;
+
+    public:
+        basic_iterator(vector<ApplicantHandle>::const_iterator pos_, Rows* rows_) : pos(pos_), rows(rows_) {}
+        Ref operator*() const { return (*rows)[*pos]; }
+        basic_iterator& operator++() { ++pos; return *this; }
+        bool operator!=(const basic_iterator& o) const { return pos != o.pos; }
+        ApplicantHandle handle() const { return *pos; }
+    };
+    using iterator = basic_iterator<vector<Student>, Student&>;
+    using const_iterator = basic_iterator<const vector<Student>, const Student&>;
+
+    template <class... Args>
+    ApplicantHandle emplace_back(Args&&... args) {
+        ApplicantHandle h = static_cast<ApplicantHandle>(students.size());
+        students.emplace_back(std::forward<Args>(args)...);
+        order.push_back(h);
+        return h;
+    }
+    Student& operator[](ApplicantHandle h) { return students[h]; }
+    const Student& operator[](ApplicantHandle h) const { return students[h]; }
+    bool contains(ApplicantHandle h) const { return h < students.size(); }
+    size_t size() const { return students.size(); }
+    bool empty() const { return students.empty(); }
+    uint64_t get_generation() const { return generation; }
+    void clear();
+    void pop_back();
+    const vector<ApplicantHandle>& handles() const { return order; }
+    void sort_by_rank();
+    void set_order(vector<ApplicantHandle> listing);
+
+    // Builds `count` students with make(i, roll) on up to `threads` workers
+    // (0 = hardware concurrency). The rolls are reserved up front and
+    // student i gets the i-th, each worker fills a contiguous slice and the
+    // slices are appended in order, so the result is the same as a
+    // sequential load.
+    template <class Make>
+    void load_parallel(size_t count, Make make, unsigned threads = 0);
+
+    // Loads an applicants CSV (ApplicantRecord::parse_csv lines; a header
+    // starting with "name" is skipped) with load_parallel. Malformed lines
+    // are counted in `skipped`; false only if the file cannot be read.
+    bool load_csv(const string& path, size_t& skipped, string& error, unsigned threads = 0);
+    iterator begin() { return iterator(order.begin(), &students); }
+    iterator end() { return iterator(order.end(), &students); }
+    const_iterator begin() const { return const_iterator(order.begin(), &students); }
+    const_iterator end() const { return const_iterator(order.end(), &students); }
+};
+
+// Process-wide metrics. Counters and histograms keep one cache-line cell
+// per shard and each thread records into its own shard, so the hot path is
+// a single relaxed atomic add. Shards are only summed when rendering.
+static const int METRIC_SHARDS = 16;
+
+int metric_shard();
+
+class MetricCounter {
+private:
+    struct alignas(64) Cell { atomic<long long> value{0}; };
+    array<Cell, METRIC_SHARDS> cells;
+
+public:
+    void inc(long long n = 1) { cells[metric_shard()].value.fetch_add(n, memory_order_relaxed); }
+    long long value() const;
+};
+
+class MetricGauge {
+private:
+    atomic<long long> current{0};
+
+public:
+    void set(long long v) { current.store(v, memory_order_relaxed); }
+    void add(long long n) { current.fetch_add(n, memory_order_relaxed); }
+    long long value() const { return current.load(memory_order_relaxed); }
+};
+
+// HDR-style log-linear histogram of nanosecond values: every power of two
+// is split into 2^SUB_BITS linear sub-buckets, so the relative error of a
+// recorded value is at most 1/2^SUB_BITS.
+class MetricHistogram {
+public:
+    static const int SUB_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int MAX_EXPONENT = 40;     // ~18 minutes in ns
+    static const int BUCKETS = (MAX_EXPONENT + 1) * SUB_BUCKETS;
+
+private:
+    struct alignas(64) Shard {
+        array<atomic<long long>, BUCKETS> counts;
+        atomic<long long> sum;
+        Shard();
+    };
+    array<Shard, METRIC_SHARDS> shards;
+
+public:
+    static int bucket_of(long long v);
+    static long long bucket_upper(int bucket);
+    void record(long long ns);
+    void merged(vector<long long>& counts, long long& sum, long long& total) const;
+    long long percentile(double p) const;
+};
+
+class MetricsRegistry {
+private:
+    struct Series {
+        string name;
+        string labels;
+        string help;
+        unique_ptr<MetricCounter> counter;
+        unique_ptr<MetricGauge> gauge;
+        unique_ptr<MetricHistogram> histogram;
+    };
+    mutable mutex lock;
+    vector<unique_ptr<Series>> series;
+
+    Series& find_or_add(const string& name, const string& labels, const string& help);
+
+public:
+    MetricCounter& counter(const string& name, const string& help, const string& labels = "");
+    MetricGauge& gauge(const string& name, const string& help, const string& labels = "");
+    MetricHistogram& histogram(const string& name, const string& help, const string& labels = "");
+    string render_prometheus() const;
+    bool write_prometheus_file(const string& path) const;
+};
+
+MetricsRegistry& metrics_registry();
+
+// Rewrites a Prometheus text file every interval (atomically via rename).
+class MetricsFileExporter {
+private:
+    string path;
+    chrono::milliseconds interval;
+    atomic<bool> running;
+    mutex wait_lock;
+    condition_variable wake;
+    thread worker;
+
+public:
+    MetricsFileExporter(string path_, chrono::milliseconds interval_);
+    ~MetricsFileExporter();
+};
+
+// Serves the Prometheus text on a local Unix socket: connect, read to EOF.
+class MetricsSocketExporter {
+private:
+    string path;
+    int listen_fd;
+    atomic<bool> running;
+    thread worker;
+
+public:
+    explicit MetricsSocketExporter(string path_);
+    bool is_listening() const;
+    ~MetricsSocketExporter();
+};
+
+// Scoped trace spans. Off by default; while off a span costs one relaxed
+// load. While on, each thread appends complete events to its own buffer
+// and write_chrome_trace() emits Chrome/Perfetto "traceEvents" JSON.
+class Tracer {
+public:
+    struct Event {
+        const char* name;
+        const char* category;
+        long long start_ns;
+        long long duration_ns;
+    };
+
+    static const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+private:
+    struct ThreadBuffer {
+        int tid;
+        mutex lock;
+        vector<Event> events;
+        size_t dropped = 0;
+    };
+    atomic<bool> on;
+    chrono::steady_clock::time_point origin;
+    mutable mutex buffers_lock;
+    vector<shared_ptr<ThreadBuffer>> buffers;
+
+    Tracer();
+    ThreadBuffer& local_buffer();
+
+public:
+    static Tracer& instance();
+    bool enabled() const { return on.load(memory_order_relaxed); }
+    void set_enabled(bool);
+    long long now_ns() const;
+    void record(const char* name, const char* category, long long start_ns, long long duration_ns);
+    size_t event_count() const;
+    void clear();
+    bool write_chrome_trace(const string& path) const;
+};
+
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    long long start_ns;
+
+public:
+    explicit TraceSpan(const char* name_, const char* category_ = "admission");
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    ~TraceSpan();
+};
+
+// Memory accounting by subsystem. Every heap block carries the tag that
+// was current on the allocating thread (see MemoryScope), so frees are
+// charged back to the subsystem that made the allocation.
+enum MemTag : unsigned char {
+    MEM_OTHER = 0,
+    MEM_APPLICANTS,
+    MEM_SEAT_STATE,
+    MEM_REPORTS,
+    MEM_UI,
+    MEM_TAG_COUNT
+};
+
+static const char* const MEM_TAG_NAMES[MEM_TAG_COUNT] = {
+    "other", "applicants", "seat state", "reports", "ui buffers"
+};
+
+struct MemoryUsage {
+    long long live_bytes;
+    long long peak_bytes;
+    long long allocations;
+    long long frees;
+};
+
+class MemoryAccounting {
+public:
+    static MemTag current_tag();
+    static void set_current_tag(MemTag);
+    static void on_allocate(MemTag, size_t);
+    static void on_free(MemTag, size_t);
+    static MemoryUsage usage(MemTag);
+    static void print_report();
+};
+
+class MemoryScope {
+private:
+    MemTag previous;
+
+public:
+    explicit MemoryScope(MemTag tag) : previous(MemoryAccounting::current_tag()) {
+        MemoryAccounting::set_current_tag(tag);
+    }
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+    ~MemoryScope() { MemoryAccounting::set_current_tag(previous); }
+};
+
+template <class Make>
+void ApplicantStore::load_parallel(size_t count, Make make, unsigned threads) {
+    if (count == 0) return;
+    if (threads == 0) threads = std::max(1u, thread::hardware_concurrency());
+    threads = (unsigned)std::min<size_t>(threads, (count + 1023) / 1024);
+
+    const int first_roll = RollAllocator::reserve((int)count);
+    size_t slice = (count + threads - 1) / threads;
+    vector<vector<Student>> parts(threads);
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            MemoryScope mem(MEM_APPLICANTS);
+            size_t begin = t * slice, end = std::min(count, begin + slice);
+            if (begin >= end) return;
+            parts[t].reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) parts[t].push_back(make(i, first_roll + (int)i));
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    MemoryScope mem(MEM_APPLICANTS);
+    students.reserve(students.size() + count);
+    order.reserve(order.size() + count);
+    for (auto& part : parts) {
+        for (auto& s : part) {
+            order.push_back((ApplicantHandle)students.size());
+            students.push_back(std::move(s));
+        }
+    }
+}
+
+// Allocation log sink. Defaults to cout; pipeline stages point it at a
+// per-thread buffer so their lines can be emitted in merit order.
+ostream& run_log();
+
+class RunLogScope {
+private:
+    ostream* previous;
+
+public:
+    explicit RunLogScope(ostream& sink);
+    RunLogScope(const RunLogScope&) = delete;
+    RunLogScope& operator=(const RunLogScope&) = delete;
+    ~RunLogScope();
+};
+
+// Fixed-capacity FIFO between pipeline stages. push() blocks while full,
+// pop() blocks while empty and returns false once the queue is closed and
+// drained.
+template <class T>
+class BoundedQueue {
+private:
+    mutex lock;
+    condition_variable not_empty;
+    condition_variable not_full;
+    deque<T> items;
+    size_t capacity;
+    bool closed;
+
+public:
+    explicit BoundedQueue(size_t capacity_) : capacity(std::max<size_t>(1, capacity_)), closed(false) {}
+
+    void push(T item) {
+        unique_lock<mutex> guard(lock);
+        not_full.wait(guard, [this]() { return items.size() < capacity || closed; });
+        if (closed) return;
+        items.push_back(std::move(item));
+        guard.unlock();
+        not_empty.notify_one();
+    }
+
+    bool pop(T& out) {
+        unique_lock<mutex> guard(lock);
+        not_empty.wait(guard, [this]() { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        guard.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> guard(lock);
+            closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+};
+
+// Read-only copies of allocation state. Reports and exports work on these
+// through AdmissionSnapshot instead of touching live Student/Branch objects.
+struct StudentView {
+    int roll;
+    string name;
+    int jee_rank;
+    int percentage_12th;
+    int age;
+    string gender;
+    string category;
+    bool eligible;
+    bool admitted;
+    string university;
+    string branch;
+    bool hostel;
+    string room;
+    bool mess;
+    string mess_plan;
+    string mess_outlet;
+};
+
+struct BranchView {
+    string name;
+    int general_remaining;
+    unordered_map<string,int> reserved_remaining;
+    int opening_rank;
+    int closing_rank;
+    void print_seat_status() const;
+};
+
+struct AdmittedView {
+    int roll;
+    string name;
+    int jee_rank;
+    string branch;
+};
+
+struct UniversityView {
+    string name;
+    int opening_rank;
+    int closing_rank;
+    vector<BranchView> branches;
+    vector<AdmittedView> admitted;
+    void print_admitted() const;
+    void print_branch_status() const;
+};
+
+struct HostelView {
+    struct Block {
+        string name;
+        int beds;
+        int free;
+    };
+    string name;
+    int total_beds;
+    int beds_allocated;
+    vector<Block> blocks;
+    void print_status() const;
+};
+
+struct MessView {
+    string name;
+    int capacity;
+    int current_allocations;
+    unordered_map<string,int> plan_prices;
+    void print_status() const;
+};
+
+// Running admission counters. AdmissionOffice updates these on every
+// allocation event so summaries never have to walk the applicant list.
+class AdmissionStats {
+public:
+    static const int RANK_BUCKETS = 32;     // bucket i holds ranks in [2^i, 2^(i+1))
+
+    size_t applicants;
+    size_t eligible;
+    size_t admitted;
+    size_t hostel_allocated;
+    size_t mess_allocated;
+    unordered_map<string, size_t> admitted_by_university;
+    unordered_map<string, size_t> admitted_by_branch;      // "University / Branch"
+    unordered_map<string, size_t> admitted_by_category;
+    unordered_map<string, size_t> admitted_by_gender;
+    unordered_map<string, size_t> hostel_by_name;
+    unordered_map<string, size_t> mess_by_plan;
+    array<size_t, RANK_BUCKETS> applicant_ranks;
+    array<size_t, RANK_BUCKETS> admitted_ranks;
+    uint64_t generation;            // ApplicantStore generation the admission counters describe
+
+    AdmissionStats();
+    static int rank_bucket(int rank);
+    void follow(uint64_t store_generation);
+    void begin_run(uint64_t store_generation);
+    void record_applicant(const Student&);
+    void record_admission(const Student&, const string& university);
+    void record_hostel(const Student&, const string& hostel);
+    void record_mess(const Student&, const string& plan);
+    size_t count(const unordered_map<string, size_t>&, const string& key) const;
+    void print_summary() const;
+};
+
+// A mess outlet. The office numbers its outlets; a student's plan records
+// which outlet serves it.
+static const int MAX_MESS_OUTLETS = 64;
+
 class Mess {
 private:
     string name;
     int capacity;
     int current_allocations;
+    int outlet;
     unordered_map<string, int> plan_prices;
 
 public:
     Mess(string name_, int capacity_);
     bool allocate_mess(Student& s, const string& plan = "Standard");
+    bool allocate_mess(Student& s, MessPlan plan);
     bool is_available() const;
+    int remaining() const { return std::max(0, capacity - current_allocations); }
+    bool offers(MessPlan) const;
+    void set_outlet(int index) { outlet = index; }
+    const string& get_name() const { return name; }
     void set_plan_price(const string& plan, int price);
+    void remove_plan(const string& plan);
     int get_plan_price(const string& plan) const;
+    MessView view() const;
     void print_status() const;
     ~Mess();
 };
 
+// Which mess plan a student gets, as an ordered rule table: the first rule
+// whose categories, income band and residence match decides, and a rule
+// may grant no plan at all. The table is flattened into one income step
+// function per (category, residence), so a decision is a binary search.
+enum class MessResidence : uint8_t { Any = 0, Hostel, Day };
+static const int NO_MESS_PLAN = -1;
+
+struct MessPlanRule {
+    uint8_t categories;             // bit per Category; 0 matches all
+    int min_income;
+    int max_income;
+    MessResidence residence;
+    int plan;                       // MessPlan, or NO_MESS_PLAN
+    bool matches(Category c, bool resident, int income) const;
+};
+
+class MessPlanRules {
+private:
+    struct Step {
+        int max_income;             // plan for incomes up to here
+        int plan;
+    };
+    vector<MessPlanRule> rules;
+    array<vector<Step>, CATEGORY_COUNT * 2> steps;     // [category * 2 + resident]
+
+    void compile();
+
+public:
+    MessPlanRules();                // the standard table
+    explicit MessPlanRules(vector<MessPlanRule>);
+    static vector<MessPlanRule> standard();
+    const vector<MessPlanRule>& get_rules() const { return rules; }
+    int decide(const Student&) const;
+};
+
+// Seat policies, chosen per university and applied as template arguments
+// so every combination compiles to its own allocation path. Reservation
+// order decides which quota a seat comes from first; the cutoff rule
+// decides whether a candidate tied with the rank of the last seat taken
+// in a quota still gets in (as a supernumerary seat).
+struct ReservedFirst { static const bool reserved_first = true; };   // category quota, then open seats
+struct MeritFirst { static const bool reserved_first = false; };     // open seats, then category quota
+struct StrictCutoff { static const bool share_ties = false; };
+struct ShareCutoff { static const bool share_ties = true; };
+
+enum class SeatGrant : unsigned char { None, Reserved, General, Supernumerary };
+
 class Branch {
 private:
     string name;
+    BranchId id;
     int general_seats;
     unordered_map<string,int> reserved_seats;
+    array<int*, CATEGORY_COUNT> reserved_by_category;  // into reserved_seats, null if none
+    int general_cutoff;                                 // rank of the last seat taken, per quota
+    array<int, CATEGORY_COUNT> reserved_cutoff;
     int opening_rank;
     int closing_rank;
 
+    bool enter(const Student&);
+    SeatGrant grant(SeatGrant, const Student&);
+
 public:
     Branch(string name_, int general_seats_, unordered_map<string,int> reserved_ = {},
            int opening_rank_ = 1, int closing_rank_ = INT_MAX);
-    virtual bool allocate_seat(const Student&);
+    Branch(const Branch&) = delete;
+    Branch& operator=(const Branch&) = delete;
+    template <class Order = ReservedFirst, class Ties = StrictCutoff>
+    SeatGrant allocate_seat(const Student&);
+    bool at_cutoff(const Student&) const;
     const string& get_name() const;
+    BranchId get_id() const;
+    int get_opening_rank() const;
+    int get_closing_rank() const;
     int seats_total() const;
     int general_remaining() const;
     int reserved_remaining(const string& category) const;
+    int reserved_remaining(Category) const;
     const unordered_map<string,int>& get_reserved_map() const;
+    BranchView view() const;
     void print_seat_status() const;
-    virtual ~Branch();
+    ~Branch();
+};
+
+template <class Order, class Ties>
+SeatGrant Branch::allocate_seat(const Student& s) {
+    if (!enter(s)) return SeatGrant::None;
+    int* reserved = reserved_by_category[(int)s.get_category_code()];
+    bool reserved_left = reserved && *reserved > 0;
+    if (Order::reserved_first && reserved_left) return grant(SeatGrant::Reserved, s);
+    if (general_seats > 0) return grant(SeatGrant::General, s);
+    if (!Order::reserved_first && reserved_left) return grant(SeatGrant::Reserved, s);
+    if (Ties::share_ties && at_cutoff(s)) return grant(SeatGrant::Supernumerary, s);
+    return SeatGrant::None;
+}
+
+// Hostel assignment rules, applied at compile time by RuleHostel.
+template <Gender G>
+struct SameGender {
+    static bool accepts(const Student& s) { return s.get_gender_code() == G; }
+    static const char* label() { return G == Gender::Male ? "boys hostel" : "girls hostel"; }
+};
+
+struct AnyGender {
+    static bool accepts(const Student&) { return true; }
+    static const char* label() { return "shared hostel"; }
+};
+
+// Which students a hostel takes; a student tries their own gender's pool
+// first and the shared pool after it.
+enum class Residents : uint8_t { Boys = 0, Girls, Any };
+
+// One bit per slot with summary levels above it: bit i of level k+1 is
+// set while word i of level k has any bit set. Finding the next set bit
+// reads one word per level up and one per level down, and setting or
+// clearing a bit touches at most the same words.
+class FreeBitset {
+private:
+    vector<vector<uint64_t>> levels;    // levels[0] holds the slots
+    size_t bits;
+
+    void clear_summary(size_t word);
+
+public:
+    FreeBitset() : levels(), bits(0) {}
+    void assign(size_t n, bool value);
+    size_t size() const { return bits; }
+    bool test(size_t i) const { return levels[0][i >> 6] & (1ull << (i & 63)); }
+    void set(size_t i);
+    void reset(size_t i);
+    size_t find_next(size_t from) const;    // size() if none
+    size_t count(size_t from, size_t end) const;
+    // Clears up to n set bits in [from, end), lowest first, appending them to out.
+    size_t take(size_t from, size_t end, size_t n, vector<uint32_t>& out);
 };
 
+// A hostel block: every room on every floor has the same number of beds.
+struct HostelBlockSpec {
+    string name;
+    int floors;
+    int rooms_per_floor;
+    int beds_per_room;
+    int beds() const { return floors * rooms_per_floor * beds_per_room; }
+};
+
+// Beds are numbered block by block, then floor, room and bed, so each
+// block is one range of bed numbers and a bed's room follows from its
+// number. free_beds has a bit set for every empty bed. Hostel(name, rooms)
+// is a single block of single rooms on one floor. Students hold campus
+// bed numbers: the office gives every hostel its own range starting at
+// first_bed.
 class Hostel {
 protected:
     string name;
-    int total_rooms;
-    int rooms_allocated;
+    vector<HostelBlockSpec> blocks;
+    vector<uint32_t> block_start;       // first bed of each block, then the total
+    FreeBitset free_beds;
+    int beds_allocated;
+    uint32_t first_bed;
+
+    void assign(Student&, bool accepted, const char* label, int block);
+    size_t assign_all(ApplicantStore&, const vector<ApplicantHandle>&, bool (*accepts)(const Student&),
+                      const char* label, int block);
 
 public:
     Hostel(string name_, int rooms);
-    virtual void allocate_room(Student&) = 0;
+    Hostel(string name_, vector<HostelBlockSpec> blocks_);
+    Hostel(const Hostel&) = delete;
+    Hostel& operator=(const Hostel&) = delete;
     bool is_available() const;
+    int bed_count() const { return (int)free_beds.size(); }
+    int free_bed_count() const { return bed_count() - beds_allocated; }
+    uint32_t get_first_bed() const { return first_bed; }
+    void set_first_bed(uint32_t bed) { first_bed = bed; }
+    bool holds(uint32_t bed) const { return bed - first_bed < free_beds.size(); }
+    uint32_t room_start(uint32_t bed) const;   // first bed of the bed's room
+    bool release(Student&);
+    int find_block(const string& block) const;
+    string describe_bed(uint32_t bed) const;
+    const string& get_name() const;
+    const vector<HostelBlockSpec>& get_blocks() const;
+    HostelView view() const;
     void print_status() const;
-    virtual ~Hostel() = default;
+    ~Hostel();
 };
 
-class BoysHostel : public Hostel {
+template <class Rule>
+class RuleHostel : public Hostel {
 public:
-    BoysHostel(string name_, int rooms);
-    void allocate_room(Student&) override;
-    ~BoysHostel() override;
+    using Hostel::Hostel;
+    // block is a preferred block index; -1 or a full block means any bed.
+    void allocate_room(Student& s, int block = -1) { assign(s, Rule::accepts(s), Rule::label(), block); }
+    // Houses a whole intake in order, taking free beds a word at a time.
+    size_t allocate_rooms(ApplicantStore& store, const vector<ApplicantHandle>& intake, int block = -1) {
+        return assign_all(store, intake, &Rule::accepts, Rule::label(), block);
+    }
 };
 
-class GirlsHostel : public Hostel {
+using BoysHostel = RuleHostel<SameGender<Gender::Male>>;
+using GirlsHostel = RuleHostel<SameGender<Gender::Female>>;
+using SharedHostel = RuleHostel<AnyGender>;
+
+// The hostels of one pool in a heap ordered by priority (lower first, e.g.
+// nearest to campus), then by most beds left, so placing a student is one
+// pop and push over H hostels. Full hostels drop out of the heap;
+// rebuild() takes in whatever changed outside a placement pass.
+template <class Rule>
+class HostelPool {
+public:
+    struct Entry {
+        unique_ptr<RuleHostel<Rule>> hostel;
+        int priority;
+    };
+
+private:
+    vector<Entry> entries;
+    vector<uint32_t> open;          // entries with a free bed, best on top
+
+    // Heap order: true when a should sit below b.
+    bool below(uint32_t a, uint32_t b) const {
+        const Entry& x = entries[a];
+        const Entry& y = entries[b];
+        if (x.priority != y.priority) return x.priority > y.priority;
+        int fx = x.hostel->free_bed_count(), fy = y.hostel->free_bed_count();
+        if (fx != fy) return fx < fy;
+        return a > b;
+    }
+
 public:
-    GirlsHostel(string name_, int rooms);
-    void allocate_room(Student&) override;
-    ~GirlsHostel() override;
+    void add(unique_ptr<RuleHostel<Rule>> hostel, int priority) {
+        entries.push_back(Entry{std::move(hostel), priority});
+    }
+    void clear() {
+        entries.clear();
+        open.clear();
+    }
+    const vector<Entry>& get_entries() const { return entries; }
+
+    void rebuild() {
+        open.clear();
+        for (uint32_t e = 0; e < entries.size(); ++e) {
+            if (entries[e].hostel->free_bed_count() > 0) open.push_back(e);
+        }
+        make_heap(open.begin(), open.end(), [this](uint32_t a, uint32_t b) { return below(a, b); });
+    }
+
+    // The hostel that housed s, or null if s is not for this pool or every
+    // hostel in it is full.
+    RuleHostel<Rule>* place(Student& s) {
+        if (open.empty() || s.has_hostel() || !Rule::accepts(s)) return nullptr;
+        auto order = [this](uint32_t a, uint32_t b) { return below(a, b); };
+        pop_heap(open.begin(), open.end(), order);
+        RuleHostel<Rule>* hostel = entries[open.back()].hostel.get();
+        hostel->allocate_room(s);
+        if (hostel->free_bed_count() > 0) push_heap(open.begin(), open.end(), order);
+        else open.pop_back();
+        return s.has_hostel() ? hostel : nullptr;
+    }
+};
+
+// Roommate survey answers: TRAITS answers on a 0-10 scale (sleep time,
+// tidiness, noise, guests, ...) and optionally the roll of a requested
+// roommate. Read from CSV lines "roll,t1,...,t8[,requested_roll]".
+struct RoommateProfile {
+    static const int TRAITS = 8;
+
+    int roll;
+    array<uint8_t, TRAITS> traits;
+    int requested_roll;             // 0 when none
+
+    bool parse_csv(const string& line);
+};
+
+// Rearranges the occupants of a hostel's rooms so roommates are alike.
+// Requests made by both students are kept together first. The rest are
+// hashed into buckets by a few random projections of their traits
+// (students with similar answers share a bucket), sorted by bucket and
+// dealt into rooms in that order, and then pairs of rooms swap occupants
+// while that lowers the total trait distance (L1) inside rooms.
+// Deterministic for a given seed.
+class RoommateMatcher {
+public:
+    static const uint32_t NO_PARTNER = 0xFFFFFFFFu;
+
+    struct Person {
+        array<uint8_t, RoommateProfile::TRAITS> traits;
+        uint32_t partner;           // index of a mutual request, or NO_PARTNER
+    };
+    struct Report {
+        size_t students;
+        size_t shared_rooms;        // rooms holding two or more
+        size_t mutual_requests;
+        size_t requests_kept;
+        double distance_before;     // mean trait distance between roommates
+        double distance_after;
+        size_t swaps;
+        double seconds;
+        void print(const string& hostel) const;
+    };
+
+    explicit RoommateMatcher(uint64_t seed = 0, int passes = 2);
+    // rooms[r] is how many people room r holds, summing to people.size().
+    // Returns people indices, room by room; people are taken to sit in
+    // room order already when measuring distance_before.
+    vector<uint32_t> match(const vector<Person>& people, const vector<int>& rooms, Report&) const;
+    static int distance(const Person& a, const Person& b);
+
+private:
+    uint64_t seed;
+    int passes;
 };
 
 class University {
@@ -130,42 +1108,875 @@ private:
     string name;
     int total_seats;
     unordered_map<string, unique_ptr<Branch>> branches;
-    vector<const Student*> admitted_students;
+    unordered_map<BranchId, Branch*> branches_by_id;
+    vector<ApplicantHandle> admitted_students;
+    uint64_t roster_generation;     // store generation the handles belong to
     int opening_rank;
     int closing_rank;
-    static int total_admitted_global;
+    uint8_t policy;                 // bit 0: MeritFirst, bit 1: ShareCutoff
+    static MetricCounter total_admitted_global;
 
 public:
     University(string, int = 1, int = INT_MAX);
+    template <class Order, class Ties>
+    void use_policy() { policy = (Order::reserved_first ? 0 : 1) | (Ties::share_ties ? 2 : 0); }
+    bool merit_first() const { return policy & 1; }
+    bool shares_ties() const { return policy & 2; }
     void add_branch(unique_ptr<Branch>);
     bool can_admit(const Student&) const;
-    bool admit_student(Student&);
-    void print_admitted() const;
+    Branch* find_branch(BranchId) const;
+    bool admit_student(ApplicantStore&, ApplicantHandle, Branch*);
+    void print_admitted(const ApplicantStore&) const;
     void print_branch_status() const;
     const unordered_map<string, unique_ptr<Branch>>& get_branches() const;
     const string& get_name() const;
+    int get_opening_rank() const;
+    int get_closing_rank() const;
     int get_admitted_count() const;
+    static long long total_admitted();
+    const vector<ApplicantHandle>& get_admitted() const;
+    bool holds_roster_of(const ApplicantStore& store) const { return store.get_generation() == roster_generation; }
+    UniversityView view(const ApplicantStore*) const;
     ~University();
 };
 
+// Student rows of one epoch, stored by handle in chunks of CHUNK_ROWS.
+// A chunk is immutable and shared with the previous epoch unless one of
+// its students changed, so a publish copies only the rows that moved.
+// Iteration follows the store's listing order.
+class StudentTable {
+public:
+    static const size_t CHUNK_ROWS = 64;
+
+    // The Student fields a row depends on besides its fixed details.
+    struct RowState {
+        int roll;
+        uint32_t university;        // index into the epoch's universities, or NO_UNIVERSITY
+        uint32_t hostel_bed;
+        BranchId branch;
+        uint8_t flags;              // admitted, hostel, mess
+        uint8_t mess_plan;
+        uint8_t outlet;
+        bool operator==(const RowState& o) const {
+            return roll == o.roll && university == o.university && branch == o.branch &&
+                   flags == o.flags && mess_plan == o.mess_plan && outlet == o.outlet &&
+                   hostel_bed == o.hostel_bed;
+        }
+    };
+    static const uint32_t NO_UNIVERSITY = 0xFFFFFFFFu;
+
+    struct Chunk {
+        vector<StudentView> rows;
+        vector<RowState> states;
+    };
+
+    class const_iterator {
+    private:
+        const StudentTable* table;
+        size_t pos;
+
+    public:
+        const_iterator(const StudentTable* table_, size_t pos_) : table(table_), pos(pos_) {}
+        const StudentView& operator*() const { return (*table)[pos]; }
+        const StudentView* operator->() const { return &(*table)[pos]; }
+        const_iterator& operator++() { ++pos; return *this; }
+        bool operator!=(const const_iterator& o) const { return pos != o.pos; }
+    };
+
+    uint64_t generation;            // ApplicantStore generation the rows came from
+    vector<shared_ptr<const Chunk>> chunks;
+    shared_ptr<const vector<ApplicantHandle>> order;     // listing order
+    shared_ptr<const vector<ApplicantHandle>> by_roll;   // handles ordered by roll
+
+    StudentTable();
+    size_t size() const { return order->size(); }
+    bool empty() const { return order->empty(); }
+    const StudentView& row(ApplicantHandle h) const { return chunks[h / CHUNK_ROWS]->rows[h % CHUNK_ROWS]; }
+    const StudentView& operator[](size_t i) const { return row((*order)[i]); }
+    const StudentView* find(int roll) const;
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+};
+
+// One published epoch of the allocation state. Immutable once published;
+// the student table is shared between epochs when only seat state changed.
+// An epoch is freed when the last reader holding it lets go.
+class AdmissionSnapshot {
+public:
+    uint64_t epoch;
+    vector<UniversityView> universities;
+    vector<HostelView> hostels;
+    vector<MessView> messes;
+    AdmissionStats stats;
+    shared_ptr<const StudentTable> students;
+
+    AdmissionSnapshot();
+    const StudentView* find_student(int roll) const;
+    void print_all_admissions() const;
+    void print_detailed_report() const;
+};
+
+// Seat matrix and allocation summary laid out for a POSIX shared-memory
+// segment, so other local processes can map it and show live seats. The
+// office is the only writer: it makes `sequence` odd, rewrites the
+// segment and makes it even again. Readers copy it out and retry while
+// the sequence was odd or moved underneath them (a seqlock). No pointers;
+// names longer than NAME_LEN - 1 are truncated. The segment header says
+// how many rows follow it. The writer sizes the segment for the campus
+// and grows it when a publish needs more rows; readers remap when the
+// header outgrows their mapping. `truncated` is set only if growing failed.
+struct SeatTableSummary {
+    uint64_t epoch;
+    int64_t applicants;
+    int64_t eligible;
+    int64_t admitted;
+    int64_t hostel_allocated;
+    int64_t mess_allocated;
+    uint32_t university_count;      // rows filled
+    uint32_t branch_count;
+    uint32_t total_universities;    // on the campus
+    uint32_t total_branches;
+    uint32_t truncated;             // 1 if some did not fit
+};
+
+struct SeatTableData : SeatTableSummary {
+    static const int NAME_LEN = 48;
+    static const int CATEGORY_COUNT = 5;    // CATEGORIES order
+
+    struct UniversityRow {
+        char name[NAME_LEN];
+        int32_t opening_rank;
+        int32_t closing_rank;
+        int32_t admitted;
+        uint32_t first_branch;
+        uint32_t branch_count;
+    };
+    struct BranchRow {
+        char name[NAME_LEN];
+        int32_t general_remaining;
+        int32_t reserved_remaining[CATEGORY_COUNT];
+        int32_t opening_rank;
+        int32_t closing_rank;
+    };
+
+    vector<UniversityRow> universities;
+    vector<BranchRow> branches;
+};
+
+struct SeatTableSegment {
+    static const uint32_t MAGIC = 0x54414553;      // "SEAT"
+    static const uint32_t LAYOUT_VERSION = 3;
+
+    uint32_t magic;
+    uint32_t layout_version;
+    atomic<uint64_t> sequence;
+    uint32_t university_capacity;   // UniversityRows after the header
+    uint32_t branch_capacity;       // BranchRows after those
+    SeatTableSummary summary;
+
+    static size_t bytes_for(uint32_t universities, uint32_t branches);
+    SeatTableData::UniversityRow* university_rows() {
+        return reinterpret_cast<SeatTableData::UniversityRow*>(this + 1);
+    }
+    SeatTableData::BranchRow* branch_rows() {
+        return reinterpret_cast<SeatTableData::BranchRow*>(university_rows() + university_capacity);
+    }
+};
+
+class SeatTablePublisher {
+private:
+    string name;
+    int fd;
+    SeatTableSegment* segment;
+    size_t mapped;
+
+    bool reserve(uint32_t universities, uint32_t branches);
+
+public:
+    SeatTablePublisher(string name_, uint32_t universities, uint32_t branches);
+    bool is_open() const;
+    void publish(const AdmissionSnapshot&);
+    ~SeatTablePublisher();
+};
+
+class SeatTableReader {
+private:
+    int fd;
+    const SeatTableSegment* segment;
+    size_t mapped;
+
+    bool remap();
+
+public:
+    explicit SeatTableReader(const string& name);
+    bool is_open() const;
+    bool read(SeatTableData& out);
+    ~SeatTableReader();
+};
+
+// Declared campus layout: universities with their branches, the hostels,
+// the mess outlets and the mess plan rules. Read from a config file, built in code or typed
+// in by a frontend. The office keeps the layout it was set up with as the
+// one record of what was configured; live seat counts are in the Branches.
+//
+// Config files are line based, '#' starts a comment and names are quoted:
+//   hostel boys "Boys Hostel A" 40
+//   hostel girls "Girls Hostel B" priority=1
+//   block "North" 4 25 2
+//   hostel any "International House" 60 priority=2
+//   mess "Main Campus Mess" 60 Basic=2000 Standard=3000 Premium=4500
+//   plan Basic category=SC,ST income=0-100000 [hostel|day]
+//   university "TechVille Institute of Technology" 1 50000 [merit-first] [share-ties]
+//   branch "Computer Science" 15 1 5000 OBC=5 SC=3 ST=2 EWS=2
+// A branch belongs to the university above it; the numbers are general
+// seats, opening rank and closing rank. A block belongs to the hostel above
+// it and gives floors, rooms per floor and beds per room; a room count on
+// the hostel line is a block of single rooms. Hostels of a pool fill in
+// priority order, lowest first (0 by default). Every mess line is an
+// outlet; one that lists prices offers only those plans. Plan lines are tried in order and the first that matches a
+// student's category, income and residence decides ("plan none" gives no
+// plan); without any the standard rules apply. load() keeps the validated
+// layout as a binary image next to the file (path + ".bin") and maps that
+// instead of parsing while the file's size and modification time are
+// unchanged.
+struct CampusConfig {
+    struct BranchSpec {
+        string name;
+        int general_seats;
+        array<int, CATEGORY_COUNT> reserved;    // CATEGORIES order
+        int opening_rank;
+        int closing_rank;
+    };
+    struct UniversitySpec {
+        string name;
+        int opening_rank;
+        int closing_rank;
+        bool merit_first;
+        bool share_ties;
+        vector<BranchSpec> branches;
+    };
+    struct HostelSpec {
+        string name;
+        Residents residents;
+        int priority;
+        vector<HostelBlockSpec> blocks;
+    };
+    struct MessSpec {
+        string name;
+        int capacity;
+        array<int, 3> prices;                   // MESS_PLANS order, -1 if not offered
+    };
+
+    vector<UniversitySpec> universities;
+    vector<HostelSpec> hostels;
+    vector<MessSpec> messes;
+    vector<MessPlanRule> plan_rules;        // empty for MessPlanRules::standard()
+
+    size_t branch_count() const;
+    bool parse(istream&, string& error);
+    bool load(const string& path, string& error);
+    bool read_cache(const string& path, uint64_t source_size, int64_t source_mtime);
+    bool write_cache(const string& path, uint64_t source_size, int64_t source_mtime) const;
+};
+
+CampusConfig default_campus();
+
+// Money in paise. Fees are set in whole rupees and every charge and waiver
+// is integer arithmetic, so a billing cycle is exactly reproducible.
+typedef int64_t Paise;
+
+// Fees for billing, read from a file of lines like
+//   tuition "TechVille Institute of Technology" 120000
+//   tuition "TechVille Institute of Technology" "Computer Science" 150000
+//   hostel "Boys Hostel A" 3500
+//   waiver "SC/ST freeship" category=SC,ST tuition=100% hostel=50%
+//   waiver "Means-based" income=-250000 tuition=37.5%
+// Tuition is annual, for a whole university or one of its branches, and is
+// billed in 12 monthly cycles with the last one carrying the rounding
+// remainder. Hostel rent is monthly; mess charges are the plan price at the
+// student's outlet. The first waiver matching a student's category and
+// income takes its percentage off each charge, rounded down to the paisa.
+// Tuition is at most MAX_TUITION and rent or a mess price MAX_MONTHLY, so
+// a month's charges per student fit in 32 bits of paise.
+struct FeeSchedule {
+    static const int CYCLES = 12;
+    static const int MAX_WAIVERS = 1024;
+    static const int MAX_TUITION = 10000000;
+    static const int MAX_MONTHLY = 1000000;
+
+    struct Tuition {
+        string university;
+        string branch;                  // empty for the university's default
+        int rupees;
+    };
+    struct Waiver {
+        string name;
+        uint8_t categories;             // bit per Category; 0 matches all
+        int min_income;
+        int max_income;
+        array<int, 3> basis_points;     // off tuition, hostel rent, mess
+    };
+
+    vector<Tuition> tuition;
+    vector<pair<string, int>> hostel_rent;
+    vector<Waiver> waivers;
+
+    bool parse(istream&, string& error);
+    bool load(const string& path, string& error);
+};
+
+// One month's bill for a set of students, kept column by column: the
+// office gathers each student's fees into the input columns, compute()
+// fills the charge columns in branch-free loops over them, and the
+// invoices are written out in one buffered pass. Every column compute()
+// works on is 32 bits wide, charges in paise, so its loops vectorize.
+class BillingCycle {
+public:
+    struct Report {
+        int cycle;
+        size_t students;
+        size_t waived_students;
+        Paise tuition;
+        Paise hostel;
+        Paise mess;
+        Paise waived;
+        Paise total;
+        double seconds;
+        void print() const;
+    };
+
+    explicit BillingCycle(int cycle = 1);
+    void reserve(size_t students);
+    void add(ApplicantHandle, const Student&, int tuition_rupees, int hostel_rupees, int mess_rupees);
+    size_t size() const { return handle.size(); }
+    int get_cycle() const { return cycle; }
+    Report compute(const FeeSchedule&);
+    bool write_invoices(const string& path, const ApplicantStore&, const FeeSchedule&) const;
+
+    vector<ApplicantHandle> handle;
+    vector<int32_t> income;
+    vector<uint32_t> category_bit;      // 1 << Category
+    vector<uint32_t> tuition_fee;       // annual, rupees
+    vector<uint32_t> hostel_rent;       // monthly, rupees
+    vector<uint32_t> mess_price;        // monthly, rupees
+    vector<uint32_t> tuition;           // this cycle, paise
+    vector<uint32_t> hostel;
+    vector<uint32_t> mess;
+    vector<uint32_t> waiver;
+    vector<uint32_t> total;
+    vector<int32_t> waiver_rule;        // index into FeeSchedule::waivers, -1 for none
+
+private:
+    int cycle;
+};
+
+string format_paise(Paise);
+
+// Scholarship schemes, read from a file of lines like
+//   scheme "Post-Matric SC/ST" category=SC,ST income=-250000 award=50000 budget=20000000
+//   scheme "Top Scorers" marks=95 award=25000 budget=2500000
+// A scheme takes students in one of its categories (any when none are
+// given), inside its income band and with at least its 12th percentage.
+// Awards are whole rupees per student; a budget (0 for none) caps the
+// scheme's total and is spent in merit order. Schemes are independent, so
+// a student may hold several.
+struct ScholarshipCatalog {
+    static const int MAX_SCHEMES = 4096;
+
+    struct Scheme {
+        string name;
+        uint8_t categories;             // bit per Category; 0 matches all
+        int min_income;
+        int max_income;
+        int min_percentage;
+        int award;
+        int64_t budget;                 // rupees, 0 for no cap
+    };
+
+    vector<Scheme> schemes;
+
+    bool parse(istream&, string& error);
+    bool load(const string& path, string& error);
+};
+
+// Every scheme against every student at once. Students are added in merit
+// order into income, category and percentage columns; evaluate() walks the
+// columns 64 students at a time and tests each block against every
+// scheme with branch-free compares packed into one eligibility word per
+// scheme, then spends each budget down that scheme's bitmap.
+class ScholarshipRound {
+public:
+    struct Result {
+        size_t eligible;
+        size_t awarded;
+        Paise granted;
+        bool capped;                    // eligible students left unfunded
+    };
+    struct Report {
+        size_t students;
+        size_t schemes;
+        size_t eligible;                // (student, scheme) pairs
+        size_t awards;
+        Paise granted;
+        double seconds;
+        void print() const;
+    };
+
+    void reserve(size_t students);
+    void add(ApplicantHandle, const Student&);
+    void add_admitted(const ApplicantStore&);   // in listing order, merit order after a run
+    size_t size() const { return handle.size(); }
+    Report evaluate(const ScholarshipCatalog&);
+    bool is_eligible(size_t scheme, size_t student) const;
+    void print_results(const ScholarshipCatalog&) const;
+    bool write_awards(const string& path, const ApplicantStore&, const ScholarshipCatalog&) const;
+    bool write_bitmaps(const string& path, const ApplicantStore&) const;
+
+    vector<ApplicantHandle> handle;
+    vector<int32_t> income;
+    vector<uint8_t> category_bit;       // 1 << Category
+    vector<uint8_t> percentage;
+    vector<vector<uint64_t>> eligible;  // [scheme][student / 64]
+    vector<vector<uint32_t>> awards;    // [scheme] -> students, in merit order
+    vector<Result> results;
+};
+
+// Meal taps at the mess outlets, counted into rolling headcounts per
+// outlet, plan and meal slot. A slot is one meal on one day; slots are
+// numbered day * MEAL_SLOTS + meal in local time. Each ingest thread
+// counts into its own shard, a ring of the latest RING_SLOTS slots, with
+// plain stores by the one writer, so the tap path takes no locks and no
+// read-modify-write atomics. Queries sum the shards while taps keep
+// arriving; a bucket being recycled for a newer slot is seen as empty.
+struct MealTap {
+    int64_t time;                   // unix seconds
+    int32_t roll;
+    int32_t outlet;                 // the office's outlet index
+};
+
+enum class Meal : uint8_t { Breakfast = 0, Lunch, Snacks, Dinner };
+static const int MEAL_SLOTS = 4;
+const string& meal_name(Meal);
+
+class MessAttendance {
+public:
+    static const int RING_SLOTS = 32;           // a week of slots plus the current day
+    static const int TREND_SLOTS = 7 * MEAL_SLOTS;
+    static const int PLANS = 3;                 // MESS_PLANS order
+
+    enum class Tap : uint8_t { Counted, Malformed, UnknownStudent, OffHours, Late };
+    struct Totals {
+        uint64_t counted;
+        uint64_t malformed;
+        uint64_t unknown;
+        uint64_t off_hours;
+        uint64_t late;
+    };
+    using Headcount = vector<array<uint64_t, PLANS>>;   // [outlet][plan]
+
+    MessAttendance(int outlets, unsigned shards, int utc_offset_seconds = 19800);
+    MessAttendance(const MessAttendance&) = delete;
+    MessAttendance& operator=(const MessAttendance&) = delete;
+
+    // Plans by roll; taps by rolls without one are not counted.
+    void set_plan(int roll, MessPlan);
+    void load_roster(const AdmissionSnapshot&);
+    int64_t slot_of(int64_t time) const;        // -1 outside meal hours
+    static bool parse_tap(string_view line, MealTap&);   // "time,outlet,roll"
+    Tap record(unsigned shard, const MealTap&);
+    // Reads "time,outlet,roll" lines from fd until end of file, parsing
+    // and counting on one worker per shard. Returns the lines read.
+    size_t ingest(int fd);
+
+    int64_t current_slot() const { return latest.load(memory_order_acquire); }
+    Headcount headcount(int64_t slot) const;
+    // Totals of the TREND_SLOTS slots up to and including `slot`, oldest
+    // first; outlet -1 sums every outlet.
+    vector<uint64_t> weekly_trend(int64_t slot, int outlet = -1) const;
+    Totals totals() const;
+    int get_outlets() const { return outlets; }
+    unsigned get_shards() const { return (unsigned)shards.size(); }
+
+private:
+    struct Bucket {
+        atomic<int64_t> slot;                   // RECYCLING while being reset
+        vector<atomic<uint32_t>> counts;        // [outlet * PLANS + plan]
+    };
+    struct alignas(64) Shard {
+        array<Bucket, RING_SLOTS> ring;
+        array<atomic<uint64_t>, 5> taps;        // by Tap
+    };
+    static const int64_t RECYCLING = -2;
+
+    int outlets;
+    int utc_offset;
+    vector<uint8_t> plan_by_roll;               // PLANS for none
+    vector<unique_ptr<Shard>> shards;
+    atomic<int64_t> latest;                     // newest slot counted, -1 before any
+
+    bool read_bucket(const Bucket&, int64_t slot, vector<uint64_t>& into) const;
+};
+
+// Which seats a student could still get, kept as bitsets over every
+// (university, branch) slot: one "full" set per category, updated as seats
+// go, and one set of slots whose combined rank window excludes the current
+// rank. The window set is swept forward over slots sorted by opening and
+// closing rank, so moving through a merit list costs one pass in total.
+// A clear bit in both means Branch::allocate_seat will succeed. Slots are
+// looked up per university by branch id, so the tables grow with the
+// branches each university offers, not with every branch on campus.
+static const uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+class SeatIndex {
+public:
+    struct Slot {
+        University* university;
+        Branch* branch;
+        int opening_rank;           // university and branch windows combined
+        int closing_rank;
+    };
+
+private:
+    vector<Slot> slots;
+    vector<pair<BranchId, uint32_t>> slot_of;  // (branch id, slot), sorted within each university
+    vector<uint32_t> first_slot;    // per university into slot_of, plus one past the end
+    unordered_map<string, uint32_t> university_of;
+    array<vector<uint64_t>, CATEGORY_COUNT> full;    // per Category
+    vector<uint64_t> out_of_window;
+    vector<uint32_t> by_opening;
+    vector<uint32_t> by_closing;
+    size_t opened;
+    size_t closed;
+    int sweep_rank;
+
+    static void set_bit(vector<uint64_t>& bits, uint32_t i, bool on) {
+        if (on) bits[i >> 6] |= 1ull << (i & 63);
+        else bits[i >> 6] &= ~(1ull << (i & 63));
+    }
+
+public:
+    SeatIndex();
+    void build(const vector<unique_ptr<University>>&);
+    void reset();
+    bool empty() const { return slots.empty(); }
+    uint32_t find(size_t university, BranchId branch) const {
+        auto first = slot_of.begin() + first_slot[university];
+        auto last = slot_of.begin() + first_slot[university + 1];
+        auto it = lower_bound(first, last, make_pair(branch, 0u));
+        return it != last && it->first == branch ? it->second : NO_SLOT;
+    }
+    size_t university(const string& name) const {
+        auto it = university_of.find(name);
+        return it == university_of.end() ? SIZE_MAX : it->second;
+    }
+    const Slot& operator[](uint32_t slot) const { return slots[slot]; }
+    void seek(int rank);
+    bool feasible(uint32_t slot, Category c) const {
+        uint64_t mask = 1ull << (slot & 63);
+        return !((full[(int)c][slot >> 6] | out_of_window[slot >> 6]) & mask);
+    }
+    bool in_window(uint32_t slot) const { return !(out_of_window[slot >> 6] & (1ull << (slot & 63))); }
+    void refresh(uint32_t slot);
+};
+
 class AdmissionOffice {
 private:
     vector<unique_ptr<University>> universities;
-    unique_ptr<BoysHostel> boys_hostel;
-    unique_ptr<GirlsHostel> girls_hostel;
-    unique_ptr<Mess> mess;
+    HostelPool<SameGender<Gender::Male>> boys_hostels;
+    HostelPool<SameGender<Gender::Female>> girls_hostels;
+    HostelPool<AnyGender> shared_hostels;
+    uint32_t next_bed;              // first campus bed number of the next hostel added
+    vector<unique_ptr<Mess>> messes;    // outlet i serves students with mess_outlet i
+    MessPlanRules plan_rules;
+    AdmissionStats stats;
+    shared_ptr<const AdmissionSnapshot> current_snapshot;
+    uint64_t next_epoch;
+    size_t snapshot_interval;
+    unique_ptr<MetricsFileExporter> metrics_file;
+    unique_ptr<MetricsSocketExporter> metrics_socket;
+    unique_ptr<SeatTablePublisher> seat_table;
+    const ApplicantStore* roster;   // last store published; resolves rosters between runs
+    string run_export_path;
+    CampusConfig campus;            // as configured; live state is in the objects below it
+
+    // Seat table indexed by ProgramId, resolved once per program so the
+    // allocator walks preference lists without name lookups.
+    struct ProgramSeat {
+        uint32_t slot;              // NO_SLOT for any university, or if not offered here
+        BranchId branch_id;
+        bool any_university;
+    };
+    vector<ProgramSeat> program_seats;
+    SeatIndex seat_index;
+    bool seat_index_stale;          // universities added since the index was built
+
+    shared_ptr<const AdmissionSnapshot> build_snapshot(const ApplicantStore*) const;
+    shared_ptr<const StudentTable> build_student_table(const ApplicantStore&, const AdmissionSnapshot&) const;
+    void install_snapshot(const shared_ptr<const AdmissionSnapshot>&);
+    void install_university(unique_ptr<University>, CampusConfig::UniversitySpec);
+    void reset_seat_index();
+    void resolve_programs();
+    const string* decide_seat(ApplicantStore&, ApplicantHandle, bool eligible);
+    void install_hostel(Hostel&, CampusConfig::HostelSpec);
+    void allocate_facilities(ApplicantStore&, const pmr::vector<ApplicantHandle>& admitted);
 
 public:
     AdmissionOffice();
     void add_university(unique_ptr<University>);
+    void add_university(const CampusConfig::UniversitySpec&);
+    void load_campus(const CampusConfig&);
+    const CampusConfig& get_campus() const;
     void set_hostels(unique_ptr<BoysHostel>, unique_ptr<GirlsHostel>);
+    void add_hostel(unique_ptr<BoysHostel>, int priority = 0);
+    void add_hostel(unique_ptr<GirlsHostel>, int priority = 0);
+    void add_hostel(unique_ptr<SharedHostel>, int priority = 0);
+    const Hostel* hostel_of(const Student&) const;
+    vector<pair<string, RoommateMatcher::Report>> match_roommates(ApplicantStore&, const vector<RoommateProfile>&,
+                                                                  uint64_t seed = 0);
     void set_mess(unique_ptr<Mess>);
-    void process_applications(vector<Student>&);
+    bool add_mess(unique_ptr<Mess>);
+    const Mess* mess_of(const Student&) const;
+    void set_mess_rules(vector<MessPlanRule>);
+    const MessPlanRules& get_mess_rules() const;
+    BillingCycle billing_cycle(const ApplicantStore&, const FeeSchedule&, int cycle = 1) const;
+    void set_snapshot_interval(size_t students);
+    shared_ptr<const AdmissionSnapshot> publish_snapshot();
+    shared_ptr<const AdmissionSnapshot> publish_snapshot(const ApplicantStore&);
+    shared_ptr<const AdmissionSnapshot> snapshot() const;
+    const AdmissionStats& get_stats() const;
+    void export_metrics_to_file(const string& path, int interval_ms = 1000);
+    bool export_metrics_on_socket(const string& path);
+    void export_metrics_from_env();
+    bool share_seat_table(const string& shm_name);
+    void set_run_export(const string& csv_path);
+    void process_applications(ApplicantStore&);
+    void process_out_of_core(ExternalMeritSorter& merit, ApplicantStore& admitted);
     void show_all_admissions() const;
     void show_detailed_report() const;
-    void show_eligibility_report(const vector<Student>& applicants) const;
+    void show_eligibility_report(const ApplicantStore& applicants) const;
     const vector<unique_ptr<University>>& get_universities() const;
     ~AdmissionOffice();
 };
 
+void setup_default_campus(AdmissionOffice&);
+
+// Binary protocol spoken by the admission daemon over a local Unix stream
+// socket. A frame is a 4-byte payload length, a 1-byte opcode (requests)
+// or status (responses), then the payload. Integers travel in host byte
+// order and strings as a 1-byte length plus bytes; the socket never
+// leaves the machine.
+enum class WireOp : uint8_t { Submit = 1, Status = 2, RunRound = 3, Summary = 4 };
+enum class WireStatus : uint8_t { Ok = 0, NotFound = 1, BadRequest = 2, Unavailable = 3 };
+static const uint32_t WIRE_MAX_PAYLOAD = 64 * 1024;
+
+class WireWriter {
+private:
+    string buf;
+
+public:
+    void u8(uint8_t v) { buf.push_back((char)v); }
+    void i32(int32_t v) { buf.append((const char*)&v, sizeof v); }
+    void i64(int64_t v) { buf.append((const char*)&v, sizeof v); }
+    void str(string_view v);
+    const string& data() const { return buf; }
+};
+
+class WireReader {
+private:
+    const char* pos;
+    const char* end;
+    bool ok;
+
+    bool take(void* out, size_t n);
+
+public:
+    explicit WireReader(const string& payload);
+    uint8_t u8();
+    int32_t i32();
+    int64_t i64();
+    string str();
+    bool good() const { return ok; }
+};
+
+bool wire_send(int fd, uint8_t code, const string& payload);
+bool wire_recv(int fd, uint8_t& code, string& payload);
+
+// Applicant fields as submitted, before they are packed into a Student.
+struct ApplicantRecord {
+    string name;
+    int income = 0;
+    int jee_rank = 0;
+    vector<string> preferences;
+    string contact;
+    int percentage_12th = 0;
+    int age = 0;
+    string gender;
+    string category;
+    bool has_score = false; // raw exam result columns were present
+    int score = 0;
+    int maths = 0;
+    int physics = 0;
+
+    void encode(WireWriter&) const;
+    bool decode(WireReader&);
+    bool parse_csv(const string& line);
+    Student make(int roll = 0) const;
+};
+
+// Raw exam result for one candidate. Higher scores and marks are better;
+// negative marking is allowed.
+struct ScoreRecord {
+    uint32_t id;                // caller's index, e.g. an ApplicantHandle
+    int score;
+    int maths;
+    int physics;
+    int percentage_12th;
+    int age;
+    Category category;
+};
+
+struct MeritRank {
+    uint32_t id;
+    int common_rank;
+    int category_rank;
+};
+
+// Turns raw scores into a merit list. Every record is packed into one
+// 64-bit key where smaller is better:
+//   [63..48] score  [47..38] maths  [37..28] physics  [27..21] 12th %
+//   [20..14] age, older first  [13..0] seeded lottery
+// and the id breaks whatever ties remain, so ranks are unique and
+// repeatable for a given seed. Keys are sorted in parallel chunks which
+// are then merged pairwise, also in parallel.
+class MeritListBuilder {
+public:
+    static const int SCORE_OFFSET = 1 << 15;    // scores in [-32768, 32767]
+    static const int MARKS_OFFSET = 1 << 9;     // subject marks in [-512, 511]
+    // build() keeps everything in memory: the records, a 16-byte sort
+    // entry each and the ranks, this much per record at its peak.
+    static const size_t BYTES_PER_RECORD = sizeof(ScoreRecord) + 16 + sizeof(MeritRank);
+
+    explicit MeritListBuilder(uint64_t lottery_seed = 0, unsigned threads = 0);
+    uint64_t pack_key(const ScoreRecord&) const;
+    vector<MeritRank> build(const vector<ScoreRecord>&) const;    // in common-rank order
+    static void apply(const vector<MeritRank>&, ApplicantStore&);
+
+private:
+    uint64_t seed;
+    unsigned threads;
+};
+
+// Out-of-core merit ordering. Records are buffered up to a memory budget,
+// sorted by (rank, arrival) and spilled to disk as runs of length-prefixed
+// wire frames; finish() then k-way merges the runs so next() yields every
+// record in merit order. The budget reads at most one MERGE_BUFFER per
+// open run, so with more runs than that allows finish() first merges
+// them in groups on disk. If nothing was spilled the buffer is served
+// directly. Run files are removed when the sorter goes away.
+class ExternalMeritSorter {
+public:
+    static const size_t MERGE_BUFFER = 64 * 1024;
+
+private:
+    struct Entry {
+        int32_t rank;
+        uint64_t seq;
+        string frame;
+    };
+    struct RunReader {
+        ifstream in;
+        vector<char> buffer;
+        Entry head;
+        bool has_head;
+    };
+    struct HeapItem {
+        int32_t rank;
+        uint64_t seq;
+        size_t run;
+        bool operator>(const HeapItem& o) const { return rank != o.rank ? rank > o.rank : seq > o.seq; }
+    };
+
+    size_t budget;
+    string dir;
+    vector<Entry> pending;
+    size_t pending_bytes;
+    uint64_t next_seq;
+    vector<string> run_paths;       // runs on disk now
+    size_t spills;
+    size_t next_run;                // names run files
+    vector<unique_ptr<RunReader>> runs;
+    priority_queue<HeapItem, vector<HeapItem>, greater<HeapItem>> heap;
+    size_t pending_pos;
+    bool finished;
+
+    void spill();
+    string new_run_path();
+    static void write_entry(ostream&, const Entry&);
+    unique_ptr<RunReader> open_run(const string& path, size_t buffer_size);
+    bool read_entry(RunReader&);
+    void merge_runs(size_t first, size_t count);
+
+public:
+    ExternalMeritSorter(size_t budget_bytes, string tmp_dir);
+    void add(const ApplicantRecord&);
+    void finish();
+    bool next(ApplicantRecord& out, uint64_t& seq);
+    uint64_t total() const { return next_seq; }
+    size_t spilled_runs() const { return spills; }
+    ~ExternalMeritSorter();
+};
+
+// Owns one AdmissionOffice and serves the wire protocol. Submissions and
+// round triggers go through a single writer thread that drains them in
+// batches, so rolls follow arrival order. A Submit is answered as soon as
+// its roll is assigned; new applicants are published PUBLISH_DELAY_MS
+// later, or earlier when a Status or Summary request needs them, so a
+// client still reads its own writes. Those requests are answered on the
+// connection's thread from the current snapshot and wait for the writer
+// only while submissions are unpublished.
+class AdmissionDaemon {
+public:
+    static const int PUBLISH_DELAY_MS = 100;
+
+private:
+    struct Job {
+        enum Kind { Submit, Round, Publish } kind;
+        ApplicantRecord applicant;              // Submit only
+        promise<long long> done;                // roll, or admitted total for a round
+    };
+    struct Client {
+        int fd = -1;
+        atomic<bool> finished{false};
+        thread worker;
+    };
+
+    AdmissionOffice& office;
+    ApplicantStore applicants;
+    string path;
+    int listen_fd;
+    atomic<bool> running;
+    thread acceptor;
+    thread writer;
+    mutex queue_lock;
+    condition_variable queue_ready;
+    deque<Job> queue;
+    atomic<bool> unpublished;       // applicants added since the last publish
+    mutex clients_lock;
+    list<Client> clients;
+
+    void accept_loop();
+    void writer_loop();
+    void serve(int fd);
+    bool handle(int fd, uint8_t op, const string& payload);
+    long long enqueue(Job::Kind, ApplicantRecord applicant = ApplicantRecord());
+    bool sync();
+
+public:
+    AdmissionDaemon(AdmissionOffice& office_, string path_);
+    bool is_listening() const;
+    void stop();
+    ~AdmissionDaemon();
+};
+
+
 #endif
\ No newline at end of file